@@ -21,6 +21,7 @@ extern void_func_t the_finalize;
 extern int_func_t the_compute;
 
 extern unsigned opencl_used;
+extern unsigned unfinished_frames;
 extern char *version;
 
 unsigned get_nb_cores (void);
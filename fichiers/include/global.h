@@ -9,6 +9,7 @@ extern unsigned do_first_touch;
 extern int max_iter;
 extern char *pngfile;
 extern char *draw_param;
+extern char *vec_isa;
 
 extern unsigned DIM;
 extern unsigned GRAIN;
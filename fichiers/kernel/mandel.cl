@@ -5,39 +5,14 @@
 /////////////////////////////// mandelbrot
 ////////////////////////////////////////////////////////////////////////////////
 
-static unsigned mandel_iter2color (unsigned iter)
-{
-  unsigned r = 0, g = 0, b = 0;
-
-  if (iter < 64) {
-    r = iter * 2;    /* 0x0000 to 0x007E */
-  } else if (iter < 128) {
-    r = (((iter - 64) * 128) / 126) + 128;    /* 0x0080 to 0x00C0 */
-  } else if (iter < 256) {
-    r = (((iter - 128) * 62) / 127) + 193;    /* 0x00C1 to 0x00FF */
-  } else if (iter < 512) {
-    r = 255;
-    g = (((iter - 256) * 62) / 255) + 1;    /* 0x01FF to 0x3FFF */
-  } else if (iter < 1024) {
-    r = 255;
-    g = (((iter - 512) * 63) / 511) + 64;   /* 0x40FF to 0x7FFF */
-  } else if (iter < 2048) {
-    r = 255;
-    g = (((iter - 1024) * 63) / 1023) + 128;   /* 0x80FF to 0xBFFF */
-  } else {
-    r = 255;
-    g = (((iter - 2048) * 63) / 2047) + 192;   /* 0xC0FF to 0xFFFF */
-  }
-
-  //return 0xFFFF00FF;
-    return (r << 24) | (g << 16) | (b << 8) | 255 /* alpha */;
-}
-
+// Même marge que INTERIOR_MARGIN dans mandel.c
+#define INTERIOR_MARGIN 0.95f
 
 __kernel void mandel (__global unsigned *img,
 		      float leftX, float xstep,
 		      float topY, float ystep,
-		      unsigned MAX_ITERATIONS)
+		      unsigned MAX_ITERATIONS,
+		      __constant unsigned *palette) // MAX_ITERATIONS + 1 couleurs
 {
   int i = get_global_id (1);
   int j = get_global_id (0);
@@ -45,9 +20,20 @@ __kernel void mandel (__global unsigned *img,
   float xc = leftX + xstep * j;
   float yc = topY - ystep * i;
   float x = 0.0, y = 0.0;	/* Z = X+I*Y */
+  float sx = 0.0, sy = 0.0;	/* valeur sauvegardée (Brent) */
 
   unsigned iter;
 
+  // Cardioïde principale et disque de période 2 : dans l'ensemble
+  float qx = xc - 0.25f, y2c = yc * yc;
+  float q = qx * qx + y2c;
+
+  if (q * (q + qx) < INTERIOR_MARGIN * 0.25f * y2c ||
+      (xc + 1.0f) * (xc + 1.0f) + y2c < INTERIOR_MARGIN * 0.0625f) {
+    img [i * DIM + j] = palette [MAX_ITERATIONS]; // black
+    return;
+  }
+
   // Pour chaque pixel, on calcule les termes d'une suite, et on
   // s'arrête lorsque |Z| > 2 ou lorsqu'on atteint MAX_ITERATIONS
   for (iter = 0; iter < MAX_ITERATIONS; iter++) {
@@ -62,9 +48,19 @@ __kernel void mandel (__global unsigned *img,
     /* Z = Z^2 + C */
     x = x2 - y2 + xc;
     y = twoxy + yc;
+
+    // Orbite périodique : elle ne s'échappera jamais
+    if (x == sx && y == sy) {
+      iter = MAX_ITERATIONS;
+      break;
+    }
+
+    if ((iter & (iter + 1)) == 0) {
+      sx = x;
+      sy = y;
+    }
   }
 
-  img [i * DIM + j] = (iter < MAX_ITERATIONS)
-    ? mandel_iter2color (iter)
-    : 0x000000FF; // black
+  // Même palette que la version CPU, calculée par mandel_init
+  img [i * DIM + j] = palette [iter];
 }
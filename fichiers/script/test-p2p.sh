@@ -0,0 +1,28 @@
+#!/bin/sh
+
+# Test de non-régression de la variante thread_p2p de vie : les threads sont
+# retardés autour de la génération de stabilisation de diehard (option
+# p2p_stall) pour qu'un thread s'arrête pendant qu'un voisin l'attend encore.
+# Une variante qui se bloque est interrompue au bout de TIMEOUT secondes.
+#
+# A lancer depuis le répertoire script : vie.c est recompilé avec P2P_TEST,
+# qui active l'option p2p_stall, puis sans à la fin du test.
+
+PROG=../2Dcomp
+TIMEOUT=10
+
+make -C .. -W src/vie.c P2P_TEST=1 > /dev/null || exit 1
+trap 'make -C .. -W src/vie.c > /dev/null' EXIT
+
+export OMP_NUM_THREADS=3
+
+# diehard (-s 256) se stabilise à la génération 131
+for g in 130 131 132; do
+    if ! timeout $TIMEOUT $PROG -n -k vie -v thread_p2p -s 256 -i 200 \
+            -a diehard,p2p_stall=$g > /dev/null 2>&1; then
+        echo "thread_p2p bloquée ou en échec (p2p_stall=$g)"
+        exit 1
+    fi
+done
+
+echo "thread_p2p : OK"
@@ -0,0 +1,68 @@
+// Test de non-régression de l'ordonnanceur : une rafale de tâches non
+// attachées (cpu == -1, comme dans mandel_compute_sched) soumise par le
+// thread principal une fois les workers endormis doit réveiller tous les
+// workers, et pas toujours le même.
+//
+// Compilé et lancé par test-sched.sh
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+
+#define ROUNDS 5
+#define TASKS 64
+#define TASK_NS 500000 // durée d'une tâche (attente active)
+
+static atomic_int *ran = NULL; // tâches exécutées par chaque worker
+
+static void busy_task (void *p, unsigned proc)
+{
+  struct timespec t0, t;
+
+  atomic_fetch_add (&ran[proc], 1);
+
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  do
+    clock_gettime (CLOCK_MONOTONIC, &t);
+  while ((t.tv_sec - t0.tv_sec) * 1000000000L + (t.tv_nsec - t0.tv_nsec) <
+         TASK_NS);
+}
+
+int main (void)
+{
+  unsigned P = scheduler_init (-1);
+  int ok     = 1;
+
+  ran = calloc (P, sizeof (atomic_int));
+
+  for (int r = 0; r < ROUNDS; r++) {
+    // Laisse aux workers le temps de s'endormir
+    usleep (100000);
+
+    for (int i = 0; i < P; i++)
+      atomic_store (&ran[i], 0);
+
+    for (int t = 0; t < TASKS; t++)
+      scheduler_create_task (busy_task, NULL, -1);
+
+    scheduler_task_wait ();
+
+    int active = 0;
+    for (int i = 0; i < P; i++)
+      active += (atomic_load (&ran[i]) > 0);
+
+    if (active < P) {
+      printf ("rafale %d : %d workers sur %u ont travaillé\n", r, active, P);
+      ok = 0;
+    }
+  }
+
+  scheduler_finalize ();
+  free (ran);
+
+  return !ok;
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+
+# Test de non-régression du réveil des workers de l'ordonnanceur (voir
+# test-sched.c) : chaque rafale de tâches doit occuper tous les workers.
+#
+# A lancer depuis le répertoire script
+
+CC=${CC:-gcc}
+BIN=./test-sched
+
+$CC -O2 -Wall -I../include -o $BIN test-sched.c ../src/scheduler.c \
+    ../src/debug.c $(pkg-config --cflags --libs hwloc) -lpthread || exit 1
+
+for p in 2 4 8; do
+    if ! OMP_NUM_THREADS=$p timeout 60 $BIN; then
+        echo "ordonnanceur : workers non réveillés (OMP_NUM_THREADS=$p)"
+        rm -f $BIN
+        exit 1
+    fi
+done
+
+rm -f $BIN
+echo "ordonnanceur : OK"
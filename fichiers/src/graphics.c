@@ -70,6 +70,10 @@ int graphics_display_enabled (void)
 {
   return 0;
 }
+int graphics_events_pending (void)
+{
+  return 0;
+}
 
 #else
 
@@ -386,4 +390,16 @@ int graphics_display_enabled (void)
 {
   return display;
 }
+
+// Vrai si un événement (clavier, souris, fenêtre) attend d'être traité par la
+// boucle principale. À n'appeler que depuis le thread principal
+int graphics_events_pending (void)
+{
+  if (!display)
+    return 0;
+
+  SDL_PumpEvents ();
+
+  return SDL_HasEvents (SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
 #endif
\ No newline at end of file
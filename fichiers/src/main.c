@@ -30,6 +30,11 @@ char *version            = DEFAULT_VARIANT;
 char *kernel             = DEFAULT_KERNEL;
 unsigned opencl_used     = 0;
 static unsigned do_dump  = 0;
+char *vec_isa            = NULL;
+
+// Images que le dernier appel à the_compute n'a pas terminées (voir
+// mandel_compute_progressive)
+unsigned unfinished_frames = 0;
 
 static hwloc_topology_t topology;
 
@@ -92,6 +97,8 @@ static void usage (int val)
   fprintf (stderr, "\t-g\t| --grain <G>\t\t: use G x G tiles\n");
   fprintf (stderr, "\t-h\t| --help\t\t: display help\n");
   fprintf (stderr, "\t-i\t| --iterations <n>\t: stop after n iterations\n");
+  fprintf (stderr, "\t-is\t| --isa <name>\t\t: force SIMD instruction set "
+                   "(scalar, sse4, avx2, avx512)\n");
   fprintf (stderr,
            "\t-k\t| --kernel <name>\t: override KERNEL environment variable\n");
   fprintf (stderr, "\t-l\t| --load-image <file>\t: use PNG image <file>\n");
@@ -196,6 +203,14 @@ static void filter_args (int *argc, char *argv[])
       (*argc)--;
       argv++;
       max_iter = atoi (*argv);
+    } else if (!strcmp (*argv, "--isa") || !strcmp (*argv, "-is")) {
+      if (*argc == 1) {
+        fprintf (stderr, "Error: ISA name missing\n");
+        usage (1);
+      }
+      (*argc)--;
+      argv++;
+      vec_isa = *argv;
     } else if (!strcmp (*argv, "--refresh-rate") || !strcmp (*argv, "-r")) {
       if (*argc == 1) {
         fprintf (stderr, "Error: N missing\n");
@@ -376,7 +391,8 @@ int main (int argc, char **argv)
       } while ((r || step) && !quit);
 #endif // NOSDL
       if (!stable && !quit) {
-        if (max_iter && iterations >= max_iter) {
+        // On ne s'arrête pas sur une image inachevée
+        if (max_iter && iterations >= max_iter && !unfinished_frames) {
           if (debug_enabled ('t'))
             printf ("\nArrêt après %d itérations (durée %ld.%03ld)\n",
                     iterations, temps / 1000, temps % 1000);
@@ -419,7 +435,9 @@ int main (int argc, char **argv)
               printf ("Calcul terminé en %d itérations\n", iterations);
 
           } else
-            iterations += refresh_rate;
+            // Une variante peut rendre la main avant d'avoir terminé ses
+            // images, pour que les événements soient traités sans attendre
+            iterations += refresh_rate - unfinished_frames;
 
           if (the_refresh_img)
             the_refresh_img ();
@@ -469,6 +487,8 @@ int main (int argc, char **argv)
 
     if (opencl_used)
       ocl_retrieve_image (image);
+    else if (the_refresh_img)
+      the_refresh_img ();
 
     sprintf (filename, "dump-%s-%s-dim-%d-iter-%d.png", kernel, version, DIM,
              iterations);
@@ -1,6 +1,8 @@
 
 #include "compute.h"
+#include "constants.h"
 #include "debug.h"
+#include "error.h"
 #include "global.h"
 #include "graphics.h"
 #include "monitoring.h"
@@ -9,8 +11,13 @@
 #include "pthread_distrib.h"
 #include "scheduler.h"
 
+#include <float.h>
+#include <math.h>
 #include <omp.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <string.h>
 
 #ifdef ENABLE_VECTO
 #include <immintrin.h>
@@ -19,7 +26,7 @@
 #define MAX_ITERATIONS 4096
 #define ZOOM_SPEED -0.01
 
-static unsigned iteration_to_color (unsigned iter)
+static unsigned compute_color (unsigned iter)
 {
   unsigned r = 0, g = 0, b = 0;
 
@@ -47,62 +54,270 @@ static unsigned iteration_to_color (unsigned iter)
   return (r << 24) | (g << 16) | (b << 8) | 255 /* alpha */;
 }
 
+// La palette est calculée une fois pour toutes par mandel_init : la boucle de
+// coloriage se réduit à une lecture (ou à un gather dans les versions
+// vectorielles). La case MAX_ITERATIONS correspond à l'ensemble (noir)
+static unsigned color_lut[MAX_ITERATIONS + 1] __attribute__ ((aligned (64)));
+
+static void init_color_lut (void)
+{
+  for (unsigned iter = 0; iter <= MAX_ITERATIONS; iter++)
+    color_lut[iter] = compute_color (iter);
+}
+
+static inline unsigned iteration_to_color (unsigned iter)
+{
+  return color_lut[iter];
+}
+
 // Cadre initial
 #if 0
 // Config 1
-static float leftX = -0.744;
-static float rightX = -0.7439;
-static float topY = .146;
-static float bottomY = .1459;
+#define INITIAL_FRAME                                                          \
+  {.leftX = -0.744, .rightX = -0.7439, .topY = .146, .bottomY = .1459}
 #endif
 
 #if 1
 // Config 2
-static float leftX   = -0.2395;
-static float rightX  = -0.2275;
-static float topY    = .660;
-static float bottomY = .648;
+#define INITIAL_FRAME                                                          \
+  {.leftX = -0.2395, .rightX = -0.2275, .topY = .660, .bottomY = .648}
 #endif
 
 #if 0
 // Config 3
-static float leftX = -0.13749;
-static float rightX = -0.13715;
-static float topY = .64975;
-static float bottomY = .64941;
+#define INITIAL_FRAME                                                          \
+  {.leftX = -0.13749, .rightX = -0.13715, .topY = .64975, .bottomY = .64941}
 #endif
 
-static float xstep;
-static float ystep;
+// Le même cadre est suivi en double précision. Quand le pas entre deux
+// pixels n'est plus qu'une poignée d'ulp des coordonnées en float, les
+// pixels voisins finissent par recevoir le même c : à partir de là, les
+// variantes qui passent par traiter_tuile_vec calculent en double
+#define FLOAT_STEP_ULPS 64
+
+// Une image de l'animation : son cadre, et le tampon où les variantes rangent
+// le nombre d'itérations de chaque pixel, sur 16 bits (deux fois moins
+// d'écritures qu'avec des couleurs ; les images intermédiaires qui ne seront
+// ni affichées ni sauvegardées ne sont jamais colorées, voir
+// mandel_refresh_img)
+typedef struct
+{
+  float leftX, rightX, topY, bottomY;
+  float xstep, ystep;
+  double dleftX, drightX, dtopY, dbottomY;
+  double dxstep, dystep;
+  bool use_double;
+  uint16_t *iter;
+} frame_t;
+
+static frame_t anim = INITIAL_FRAME;
+
+// Image lue et écrite par les noyaux : celle de l'animation, sauf dans les
+// threads de la version pipeline, qui calculent des images en avance
+static __thread frame_t *frame = &anim;
+
+#define cur_iter(i, j) (frame->iter[(i) * DIM + (j)])
+
+// Le tampon est alloué dès que DIM est connu : par mandel_ft_sched si le
+// placement des pages est demandé, sinon par mandel_draw. Les pages ne sont
+// réellement placées qu'à leur première écriture
+static void iter_img_alloc (void)
+{
+  if (anim.iter == NULL)
+    anim.iter = calloc (DIM * DIM, sizeof (uint16_t));
+}
+
+// Pas de motif initial : on ne fait qu'allouer le tampon
+void mandel_draw (char *param)
+{
+  iter_img_alloc ();
+}
+
+void mandel_finalize (void)
+{
+  free (anim.iter);
+  anim.iter = NULL;
+}
+
+static void update_precision (void)
+{
+  frame->dxstep = (frame->drightX - frame->dleftX) / DIM;
+  frame->dystep = (frame->dtopY - frame->dbottomY) / DIM;
+
+  frame->use_double =
+      MIN (frame->xstep, frame->ystep) <
+      FLOAT_STEP_ULPS * FLT_EPSILON *
+          MAX (MAX (fabsf (frame->leftX), fabsf (frame->rightX)),
+               MAX (fabsf (frame->topY), fabsf (frame->bottomY)));
+}
+
+// Avec « --arg skip », seule la dernière des nb_iter images d'un appel (celle
+// qui sera affichée ou sauvegardée) est calculée : les précédentes ne font
+// qu'avancer le cadre, avec la fonction de zoom de la variante. Renvoie le
+// nombre d'images sautées
+static bool skip_unseen = false;
+
+static unsigned skip_unseen_frames (unsigned nb_iter, void (*advance) (void))
+{
+  if (!skip_unseen || nb_iter < 2)
+    return 0;
+
+  for (unsigned it = 1; it < nb_iter; it++)
+    advance ();
+
+  return nb_iter - 1;
+}
 
 static void zoom (void)
 {
-  float xrange = (rightX - leftX);
-  float yrange = (topY - bottomY);
+  float xrange = (frame->rightX - frame->leftX);
+  float yrange = (frame->topY - frame->bottomY);
+
+  frame->leftX += ZOOM_SPEED * xrange;
+  frame->rightX -= ZOOM_SPEED * xrange;
+  frame->topY -= ZOOM_SPEED * yrange;
+  frame->bottomY += ZOOM_SPEED * yrange;
+
+  frame->xstep = (frame->rightX - frame->leftX) / DIM;
+  frame->ystep = (frame->topY - frame->bottomY) / DIM;
+
+  double dxrange = (frame->drightX - frame->dleftX);
+  double dyrange = (frame->dtopY - frame->dbottomY);
+
+  frame->dleftX += ZOOM_SPEED * dxrange;
+  frame->drightX -= ZOOM_SPEED * dxrange;
+  frame->dtopY -= ZOOM_SPEED * dyrange;
+  frame->dbottomY += ZOOM_SPEED * dyrange;
+
+  update_precision ();
+}
+
+// Vrai si key figure parmi les paramètres passés via --arg (séparés par des
+// virgules)
+static bool mandel_option (const char *key)
+{
+  size_t len = strlen (key);
+
+  for (const char *p = draw_param; p != NULL && *p;) {
+    const char *end = strchr (p, ',');
+    size_t n        = end ? (size_t) (end - p) : strlen (p);
+
+    if (n == len && !strncmp (p, key, len))
+      return true;
+
+    p = end ? end + 1 : NULL;
+  }
+
+  return false;
+}
+
+// Valeur du paramètre de la forme key=valeur passé via --arg, ou
+// default_value s'il est absent
+static int mandel_option_value (const char *key, int default_value)
+{
+  size_t len = strlen (key);
+
+  for (const char *p = draw_param; p != NULL && *p;) {
+    if (!strncmp (p, key, len) && p[len] == '=')
+      return atoi (p + len + 1);
 
-  leftX += ZOOM_SPEED * xrange;
-  rightX -= ZOOM_SPEED * xrange;
-  topY -= ZOOM_SPEED * yrange;
-  bottomY += ZOOM_SPEED * yrange;
+    p = strchr (p, ',');
+    if (p != NULL)
+      p++;
+  }
 
-  xstep = (rightX - leftX) / DIM;
-  ystep = (topY - bottomY) / DIM;
+  return default_value;
 }
 
+// Noyaux scalaires compilés avec FMA (voir compute_one_pixel)
+static bool use_fma = false;
+
+#ifdef ENABLE_VECTO
+static void select_isa (void);
+#endif
+
 void mandel_init ()
 {
-  xstep = (rightX - leftX) / DIM;
-  ystep = (topY - bottomY) / DIM;
+  __builtin_cpu_init ();
+  use_fma = __builtin_cpu_supports ("fma");
+
+#ifdef ENABLE_VECTO
+  select_isa ();
+#endif
+
+  init_color_lut ();
+
+  skip_unseen = mandel_option ("skip");
+
+  anim.xstep = (anim.rightX - anim.leftX) / DIM;
+  anim.ystep = (anim.topY - anim.bottomY) / DIM;
+
+  anim.dleftX   = anim.leftX;
+  anim.drightX  = anim.rightX;
+  anim.dtopY    = anim.topY;
+  anim.dbottomY = anim.bottomY;
+
+  update_precision ();
+}
+
+// Les pixels de l'ensemble vont jusqu'à MAX_ITERATIONS et coûtent le plus
+// cher. Deux raccourcis les évitent sans changer l'image :
+//
+// - la cardioïde principale et le disque de période 2 sont testés
+//   analytiquement, avec une marge qui écarte les points trop proches du bord
+//   (où l'orbite calculée en flottant pourrait tout de même s'échapper) ;
+// - à la Brent, z est comparé à chaque itération à une valeur sauvegardée aux
+//   itérations 2^k - 1 : si z retombe exactement sur cette valeur, l'orbite
+//   (calculée de façon déterministe) est périodique et ne s'échappera jamais.
+#define INTERIOR_MARGIN 0.95
+
+static inline bool in_main_bulbs (double cr, double ci)
+{
+  double x  = cr - 0.25;
+  double y2 = ci * ci;
+  double q  = x * x + y2;
+
+  return q * (q + x) < INTERIOR_MARGIN * 0.25 * y2 ||
+         (cr + 1.0) * (cr + 1.0) + y2 < INTERIOR_MARGIN * 0.0625;
 }
 
-static unsigned compute_one_pixel (int i, int j)
+// L'image de référence (seq, --isa scalar) était calculée avec -mfma, GCC
+// fusionnant alors multiplications et additions en FMA, ce qui change
+// l'arrondi. Les noyaux scalaires existent donc en deux exemplaires, avec et
+// sans FMA : le premier est choisi dès que le processeur le permet (voir
+// mandel_init), si bien que l'image ne dépend ni des options de compilation,
+// ni du jeu d'instructions vectoriel retenu
+#define TARGET_FMA __attribute__ ((target ("fma")))
+#define ALWAYS_INLINE inline __attribute__ ((always_inline))
+
+#define FMA_DISPATCH(name)                                                     \
+  TARGET_FMA static unsigned name##_fma (int i, int j)                         \
+  {                                                                            \
+    return name##_body (i, j);                                                 \
+  }                                                                            \
+                                                                               \
+  static unsigned name##_nofma (int i, int j)                                  \
+  {                                                                            \
+    return name##_body (i, j);                                                 \
+  }                                                                            \
+                                                                               \
+  static inline unsigned name (int i, int j)                                   \
+  {                                                                            \
+    return use_fma ? name##_fma (i, j) : name##_nofma (i, j);                  \
+  }
+
+static ALWAYS_INLINE unsigned compute_one_pixel_body (int i, int j)
 {
-  float cr = leftX + xstep * j;
-  float ci = topY - ystep * i;
+  float cr = frame->leftX + frame->xstep * j;
+  float ci = frame->topY - frame->ystep * i;
   float zr = 0.0, zi = 0.0;
+  float sr = 0.0, si = 0.0;
 
   int iter;
 
+  if (in_main_bulbs (cr, ci))
+    return MAX_ITERATIONS;
+
   // Pour chaque pixel, on calcule les termes d'une suite, et on
   // s'arrête lorsque |Z| > 2 ou lorsqu'on atteint MAX_ITERATIONS
   for (iter = 0; iter < MAX_ITERATIONS; iter++) {
@@ -117,21 +332,70 @@ static unsigned compute_one_pixel (int i, int j)
     /* Z = Z^2 + C */
     zr = x2 - y2 + cr;
     zi = twoxy + ci;
+
+    if (zr == sr && zi == si)
+      return MAX_ITERATIONS;
+
+    if ((iter & (iter + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+  }
+
+  return iter;
+}
+
+FMA_DISPATCH (compute_one_pixel)
+
+static ALWAYS_INLINE unsigned compute_one_pixel_double_body (int i, int j)
+{
+  double cr = frame->dleftX + frame->dxstep * j;
+  double ci = frame->dtopY - frame->dystep * i;
+  double zr = 0.0, zi = 0.0;
+  double sr = 0.0, si = 0.0;
+
+  int iter;
+
+  if (in_main_bulbs (cr, ci))
+    return MAX_ITERATIONS;
+
+  for (iter = 0; iter < MAX_ITERATIONS; iter++) {
+    double x2 = zr * zr;
+    double y2 = zi * zi;
+
+    if (x2 + y2 > 4.0)
+      break;
+
+    double twoxy = 2.0 * zr * zi;
+    zr           = x2 - y2 + cr;
+    zi           = twoxy + ci;
+
+    if (zr == sr && zi == si)
+      return MAX_ITERATIONS;
+
+    if ((iter & (iter + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
   }
 
   return iter;
 }
 
+FMA_DISPATCH (compute_one_pixel_double)
+
 ///////////////////////////// Version séquentielle simple (seq)
 
 // Renvoie le nombre d'itérations effectuées avant stabilisation, ou 0
 unsigned mandel_compute_seq (unsigned nb_iter)
 {
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
   for (unsigned it = 1; it <= nb_iter; it++) {
 
     for (int i = 0; i < DIM; i++)
       for (int j = 0; j < DIM; j++)
-        cur_img (i, j) = iteration_to_color (compute_one_pixel (i, j));
+        cur_iter (i, j) = compute_one_pixel (i, j);
 
     zoom ();
   }
@@ -143,231 +407,822 @@ unsigned mandel_compute_seq (unsigned nb_iter)
 
 #ifdef ENABLE_VECTO
 
-#if VEC_SIZE == 8
-static void compute_multiple_pixels (unsigned *iterations, int i, int j)
-{
-  __m256 zr, zi, cr, ci, norm; //, iter;
-  __m256 deux     = _mm256_set1_ps (2.0);
-  __m256 max_norm = _mm256_set1_ps (4.0);
+// Les noyaux vectoriels sont compilés pour plusieurs jeux d'instructions dans
+// le même exécutable (attribut target), et non plus pour celui du Makefile :
+// select_isa choisit au lancement le plus large que le processeur supporte,
+// ou celui imposé par --isa (scalar, sse4, avx2 ou avx512)
+#define MAX_VEC_SIZE 16
 
-  __m256i iter = _mm256_setzero_si256 ();
-  __m256i un   = _mm256_set1_epi32 (1);
-  __m256i vrai = _mm256_set1_epi32 (-1);
+#define TARGET_SSE4 __attribute__ ((target ("sse4.1")))
+#define TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+#define TARGET_AVX512 __attribute__ ((target ("avx512f,avx2,fma")))
 
-  zr = zi = norm = _mm256_set1_ps (0);
+// Remplit iterations avec les vec_size pixels (i, j + v) d'une ligne, ou
+// (i + v, j) d'une colonne
+typedef void (*iterations_func_t) (unsigned *iterations, int i, int j);
 
-  cr = _mm256_add_ps (_mm256_set1_ps (j),
-                      _mm256_set_ps (7, 6, 5, 4, 3, 2, 1, 0));
+// Range vec_size itérations consécutives dans le tampon de l'image
+typedef void (*store_func_t) (uint16_t *dst, const unsigned *iterations);
+
+// Range dans colors les couleurs de vec_size itérations consécutives du
+// tampon de l'image
+typedef void (*colorize_func_t) (unsigned *colors, const uint16_t *iterations);
 
-  cr = _mm256_fmadd_ps (cr, _mm256_set1_ps (xstep), _mm256_set1_ps (leftX));
+typedef struct
+{
+  const char *name;
+  unsigned vec_size;
+  iterations_func_t row, col;
+  store_func_t store;
+  colorize_func_t colorize;
+} simd_level_t;
+
+enum
+{
+  ISA_SCALAR,
+  ISA_SSE4,
+  ISA_AVX2,
+  ISA_AVX512,
+  NB_ISA
+};
 
-  ci = _mm256_set1_ps (topY - ystep * i);
+//////// Scalaire
 
-  for (int i = 0; i < MAX_ITERATIONS; i++) {
-    __m256 rc    = _mm256_mul_ps (zr, zr);
-    norm         = _mm256_fmadd_ps (zi, zi, rc);
-    __m256i mask = (__m256i)_mm256_cmp_ps (norm, max_norm, _CMP_LE_OS);
-    if (_mm256_testz_si256 (mask, vrai))
-      break;
-    iter = _mm256_add_epi32 (iter, _mm256_and_si256 (mask, un));
+static void compute_iterations_scalar (unsigned *iterations, int i, int j)
+{
+  iterations[0] = frame->use_double ? compute_one_pixel_double (i, j)
+                                    : compute_one_pixel (i, j);
+}
 
-    __m256 x = _mm256_add_ps (rc, _mm256_fnmadd_ps (zi, zi, cr));
-    __m256 y = _mm256_fmadd_ps (deux, _mm256_mul_ps (zr, zi), ci);
-    zr       = x;
-    zi       = y;
-  }
+static void store_scalar (uint16_t *dst, const unsigned *iterations)
+{
+  dst[0] = iterations[0];
+}
 
-  _mm256_store_si256 ((__m256i *)iterations, iter);
+static void colorize_scalar (unsigned *colors, const uint16_t *iterations)
+{
+  colors[0] = iteration_to_color (iterations[0]);
 }
 
-#elif VEC_SIZE == 4
+//////// SSE4.1 (4 floats)
 
-static void compute_multiple_pixels (unsigned *iterations, int i, int j)
+// Sans FMA ni comparaisons VEX : mêmes opérations, dans le même ordre, que
+// compute_one_pixel_nofma
+TARGET_SSE4 static __m128i iterate_pixels_sse4 (__m128 cr, __m128 ci)
 {
-  __m128 zr, zi, cr, ci, norm, iter;
+  __m128 zr, zi, iter;
   __m128 deux     = _mm_set1_ps (2.0);
   __m128 un       = _mm_set1_ps (1.0);
-  __m128 vrai     = _mm_set1_ps (-1);
   __m128 max_norm = _mm_set1_ps (4.0);
 
-  zr = zi = norm = iter = _mm_set1_ps (0);
-  cr = _mm_set_ps (leftX + xstep * (j + 3), leftX + xstep * (j + 2),
-                   leftX + xstep * (j + 1), leftX + xstep * (j + 0));
-  ci = _mm_set1_ps (topY - ystep * i);
+  zr = zi = iter = _mm_set1_ps (0);
+
+  __m128 xc   = _mm_sub_ps (cr, _mm_set1_ps (0.25));
+  __m128 xb   = _mm_add_ps (cr, _mm_set1_ps (1.0));
+  __m128 y2   = _mm_mul_ps (ci, ci);
+  __m128 q    = _mm_add_ps (_mm_mul_ps (xc, xc), y2);
+  __m128 card = _mm_cmplt_ps (
+      _mm_mul_ps (q, _mm_add_ps (q, xc)),
+      _mm_mul_ps (y2, _mm_set1_ps (INTERIOR_MARGIN * 0.25)));
+  __m128 bulb = _mm_cmplt_ps (_mm_add_ps (_mm_mul_ps (xb, xb), y2),
+                              _mm_set1_ps (INTERIOR_MARGIN * 0.0625));
+  __m128 fini     = _mm_or_ps (card, bulb);
+  __m128 max_iter = _mm_set1_ps (MAX_ITERATIONS);
+  __m128 sr = zr, si = zi;
+
+  iter = _mm_and_ps (fini, max_iter);
 
   for (int i = 0; i < MAX_ITERATIONS; i++) {
-    norm        = _mm_fmadd_ps (zr, zr, _mm_mul_ps (zi, zi));
-    __m128 mask = _mm_cmp_ps (norm, max_norm, _CMP_LE_OS);
-    if (_mm_testz_ps (mask, vrai))
+    __m128 x2   = _mm_mul_ps (zr, zr);
+    __m128 y2   = _mm_mul_ps (zi, zi);
+    __m128 mask = _mm_andnot_ps (
+        fini, _mm_cmple_ps (_mm_add_ps (x2, y2), max_norm));
+    if (_mm_movemask_ps (mask) == 0)
       break;
     iter = _mm_add_ps (iter, _mm_and_ps (mask, un));
 
-    __m128 x = _mm_fmadd_ps (zr, zr, _mm_fnmadd_ps (zi, zi, cr));
-    __m128 y = _mm_fmadd_ps (deux, _mm_mul_ps (zr, zi), ci);
-    zr       = x;
+    __m128 y = _mm_add_ps (_mm_mul_ps (_mm_mul_ps (deux, zr), zi), ci);
+    zr       = _mm_add_ps (_mm_sub_ps (x2, y2), cr);
     zi       = y;
+
+    __m128 boucle = _mm_and_ps (
+        mask, _mm_and_ps (_mm_cmpeq_ps (zr, sr), _mm_cmpeq_ps (zi, si)));
+    fini = _mm_or_ps (fini, boucle);
+    iter = _mm_blendv_ps (iter, max_iter, boucle);
+
+    if ((i & (i + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
   }
 
-  __m128i res = _mm_cvttps_epi32 (iter);
-  _mm_store_si128 ((__m128i *)iterations, res);
+  return _mm_cvttps_epi32 (iter);
 }
 
-#else
-#warning Only 128bits SSE (VEC_SIZE=4) or 256bit AVX (VEC_SIZE=8) vectorization are currently supported
-#endif
+TARGET_SSE4 static void compute_iterations_sse4 (unsigned *iterations, int i,
+                                                 int j)
+{
+  __m128 cr, ci;
 
-#endif
+  // Sans AVX, un registre ne contient que 2 doubles : on reste en scalaire
+  if (frame->use_double) {
+    for (int v = 0; v < 4; v++)
+      iterations[v] = compute_one_pixel_double (i, j + v);
+    return;
+  }
+
+  cr = _mm_set_ps (frame->leftX + frame->xstep * (j + 3),
+                   frame->leftX + frame->xstep * (j + 2),
+                   frame->leftX + frame->xstep * (j + 1),
+                   frame->leftX + frame->xstep * (j + 0));
+  ci = _mm_set1_ps (frame->topY - frame->ystep * i);
 
-#if defined(ENABLE_VECTO) && (VEC_SIZE == 4 || VEC_SIZE == 8)
+  _mm_store_si128 ((__m128i *)iterations, iterate_pixels_sse4 (cr, ci));
+}
 
-static void do_computation (int i, int j)
+TARGET_SSE4 static void compute_iterations_col_sse4 (unsigned *iterations,
+                                                     int i, int j)
 {
-  unsigned iterations[VEC_SIZE];
+  __m128 cr, ci;
+
+  if (frame->use_double) {
+    for (int v = 0; v < 4; v++)
+      iterations[v] = compute_one_pixel_double (i + v, j);
+    return;
+  }
 
-  compute_multiple_pixels (iterations, i, j);
+  cr = _mm_set1_ps (frame->leftX + frame->xstep * (j + 0));
+  ci = _mm_set_ps (frame->topY - frame->ystep * (i + 3),
+                   frame->topY - frame->ystep * (i + 2),
+                   frame->topY - frame->ystep * (i + 1),
+                   frame->topY - frame->ystep * (i + 0));
 
-  for (int v = 0; v < VEC_SIZE; v++)
-    cur_img (i, j + v) = iteration_to_color (iterations[v]);
+  _mm_store_si128 ((__m128i *)iterations, iterate_pixels_sse4 (cr, ci));
 }
 
-static void traiter_tuile_vec (int i_d, int j_d, int i_f, int j_f)
+TARGET_SSE4 static void store_sse4 (uint16_t *dst, const unsigned *iterations)
 {
-  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+  __m128i iter = _mm_load_si128 ((const __m128i *)iterations);
 
-  for (int i = i_d; i <= i_f; i++)
-    for (int j = j_d; j <= j_f; j += VEC_SIZE)
-      do_computation (i, j);
+  _mm_storel_epi64 ((__m128i *)dst, _mm_packus_epi32 (iter, iter));
 }
 
-// Renvoie le nombre d'itérations effectuées avant stabilisation, ou 0
-unsigned mandel_compute_vec (unsigned nb_iter)
+// Pas de gather avant AVX2
+TARGET_SSE4 static void colorize_sse4 (unsigned *colors,
+                                       const uint16_t *iterations)
 {
-  for (unsigned it = 1; it <= nb_iter; it++) {
+  for (int v = 0; v < 4; v++)
+    colors[v] = iteration_to_color (iterations[v]);
+}
 
-    // On traite toute l'image en une seule fois
-    traiter_tuile_vec (0, 0, DIM - 1, DIM - 1);
-    zoom ();
-  }
+//////// AVX2 + FMA (8 floats, 4 doubles)
 
-  return 0;
-}
+// Itère sur 8 valeurs de c à la fois
+TARGET_AVX2 static __m256i iterate_pixels_avx2 (__m256 cr, __m256 ci)
+{
+  __m256 zr, zi, norm; //, iter;
+  __m256 deux     = _mm256_set1_ps (2.0);
+  __m256 max_norm = _mm256_set1_ps (4.0);
 
-#else
+  __m256i iter = _mm256_setzero_si256 ();
+  __m256i un   = _mm256_set1_epi32 (1);
+  __m256i vrai = _mm256_set1_epi32 (-1);
 
-#define traiter_tuile_vec(i_d, j_d, i_f, j_f) traiter_tuile (i_d, j_d, i_f, j_f)
+  zr = zi = norm = _mm256_set1_ps (0);
 
-#endif
+  // Les pixels de la cardioïde ou du disque de période 2 sont terminés
+  // d'emblée ; les autres le seront dès que leur orbite boucle
+  __m256 xc   = _mm256_sub_ps (cr, _mm256_set1_ps (0.25));
+  __m256 xb   = _mm256_add_ps (cr, _mm256_set1_ps (1.0));
+  __m256 y2   = _mm256_mul_ps (ci, ci);
+  __m256 q    = _mm256_fmadd_ps (xc, xc, y2);
+  __m256 card = _mm256_cmp_ps (
+      _mm256_mul_ps (q, _mm256_add_ps (q, xc)),
+      _mm256_mul_ps (y2, _mm256_set1_ps (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __m256 bulb = _mm256_cmp_ps (_mm256_fmadd_ps (xb, xb, y2),
+                               _mm256_set1_ps (INTERIOR_MARGIN * 0.0625),
+                               _CMP_LT_OS);
+  __m256i fini = (__m256i)_mm256_or_ps (card, bulb);
+  __m256i max_iter = _mm256_set1_epi32 (MAX_ITERATIONS);
+  __m256 sr = zr, si = zi;
+
+  iter = _mm256_and_si256 (fini, max_iter);
 
-///////////////////////////// Version séquentielle tuilée (tiled)
+  for (int i = 0; i < MAX_ITERATIONS; i++) {
+    __m256 rc    = _mm256_mul_ps (zr, zr);
+    norm         = _mm256_fmadd_ps (zi, zi, rc);
+    __m256i mask = _mm256_andnot_si256 (
+        fini, (__m256i)_mm256_cmp_ps (norm, max_norm, _CMP_LE_OS));
+    if (_mm256_testz_si256 (mask, vrai))
+      break;
+    iter = _mm256_add_epi32 (iter, _mm256_and_si256 (mask, un));
 
-static unsigned tranche = 0;
+    __m256 x = _mm256_add_ps (rc, _mm256_fnmadd_ps (zi, zi, cr));
+    __m256 y = _mm256_fmadd_ps (deux, _mm256_mul_ps (zr, zi), ci);
+    zr       = x;
+    zi       = y;
 
-static void traiter_tuile (int i_d, int j_d, int i_f, int j_f)
-{
-  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+    __m256i boucle = _mm256_and_si256 (
+        mask, (__m256i)_mm256_and_ps (_mm256_cmp_ps (zr, sr, _CMP_EQ_OQ),
+                                      _mm256_cmp_ps (zi, si, _CMP_EQ_OQ)));
+    fini = _mm256_or_si256 (fini, boucle);
+    iter = _mm256_blendv_epi8 (iter, max_iter, boucle);
 
-  for (int i = i_d; i <= i_f; i++)
-    for (int j = j_d; j <= j_f; j++) {
-      unsigned n     = compute_one_pixel (i, j);
-      cur_img (i, j) = iteration_to_color (n);
+    if ((i & (i + 1)) == 0) {
+      sr = zr;
+      si = zi;
     }
+  }
+
+  return iter;
 }
 
-unsigned mandel_compute_tiled (unsigned nb_iter)
+TARGET_AVX2 static void compute_multiple_pixels_avx2 (unsigned *iterations,
+                                                      int i, int j)
 {
-  tranche = DIM / GRAIN;
+  __m256 cr, ci;
 
-  for (unsigned it = 1; it <= nb_iter; it++) {
+  cr = _mm256_add_ps (_mm256_set1_ps (j),
+                      _mm256_set_ps (7, 6, 5, 4, 3, 2, 1, 0));
 
-    // On itére sur les coordonnées des tuiles
-    for (int i = 0; i < GRAIN; i++)
-      for (int j = 0; j < GRAIN; j++)
-        traiter_tuile_vec (i * tranche /* i debut */, j * tranche /* j debut */,
-                           (i + 1) * tranche - 1 /* i fin */,
-                           (j + 1) * tranche - 1 /* j fin */);
+  cr = _mm256_fmadd_ps (cr, _mm256_set1_ps (frame->xstep),
+                        _mm256_set1_ps (frame->leftX));
 
-    zoom ();
-  }
+  ci = _mm256_set1_ps (frame->topY - frame->ystep * i);
 
-  return 0;
+  _mm256_store_si256 ((__m256i *)iterations, iterate_pixels_avx2 (cr, ci));
 }
 
-///////////////////////////// Version thread bloc
+// Même calcul sur les pixels (i + v, j) d'une colonne, avec les mêmes
+// expressions pour cr et ci : chaque pixel obtient la même valeur
+TARGET_AVX2 static void compute_multiple_pixels_col_avx2 (unsigned *iterations,
+                                                          int i, int j)
+{
+  float ci[8];
+  __m256 cr;
 
-static unsigned nb_threads = 2;
-static unsigned iterations = 1;
+  for (int v = 0; v < 8; v++)
+    ci[v] = frame->topY - frame->ystep * (i + v);
 
-static pthread_barrier_t barrier;
+  cr = _mm256_fmadd_ps (_mm256_set1_ps (j), _mm256_set1_ps (frame->xstep),
+                        _mm256_set1_ps (frame->leftX));
 
-static void *thread_starter_bloc (void *arg)
+  _mm256_store_si256 ((__m256i *)iterations,
+                      iterate_pixels_avx2 (cr, _mm256_loadu_ps (ci)));
+}
+
+// Même calcul en double précision, sur 4 valeurs de c seulement (les
+// compteurs sont sur 64 bits)
+TARGET_AVX2 static __m256i iterate_pixels_double_avx2 (__m256d cr, __m256d ci)
 {
-  unsigned me    = (unsigned)(intptr_t)arg;
-  unsigned slice = DIM / nb_threads;
-  unsigned i_d   = me * slice;
-  unsigned i_f   = ((me == nb_threads - 1) ? DIM - 1 : (me + 1) * slice - 1);
+  __m256d zr, zi, norm;
+  __m256d deux     = _mm256_set1_pd (2.0);
+  __m256d max_norm = _mm256_set1_pd (4.0);
 
-  PRINT_DEBUG ('t', "Thread %d/%d started, computing slice [%4u-%4u]\n", me,
-               nb_threads, i_d, i_f);
-  for (unsigned it = 1; it <= iterations; it++) {
-    traiter_tuile_vec (i_d, 0, i_f, DIM - 1);
-#ifdef ENABLE_MONITORING
-    monitoring_add_tile (0, i_d, DIM, i_f - i_d + 1, me);
-#endif
+  __m256i iter = _mm256_setzero_si256 ();
+  __m256i un   = _mm256_set1_epi64x (1);
+  __m256i vrai = _mm256_set1_epi64x (-1);
+
+  zr = zi = norm = _mm256_set1_pd (0);
+
+  __m256d xc   = _mm256_sub_pd (cr, _mm256_set1_pd (0.25));
+  __m256d xb   = _mm256_add_pd (cr, _mm256_set1_pd (1.0));
+  __m256d y2   = _mm256_mul_pd (ci, ci);
+  __m256d q    = _mm256_fmadd_pd (xc, xc, y2);
+  __m256d card = _mm256_cmp_pd (
+      _mm256_mul_pd (q, _mm256_add_pd (q, xc)),
+      _mm256_mul_pd (y2, _mm256_set1_pd (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __m256d bulb = _mm256_cmp_pd (_mm256_fmadd_pd (xb, xb, y2),
+                                _mm256_set1_pd (INTERIOR_MARGIN * 0.0625),
+                                _CMP_LT_OS);
+  __m256i fini = (__m256i)_mm256_or_pd (card, bulb);
+  __m256i max_iter = _mm256_set1_epi64x (MAX_ITERATIONS);
+  __m256d sr = zr, si = zi;
+
+  iter = _mm256_and_si256 (fini, max_iter);
 
-#ifdef __APPLE__
-    pthread_barrier_single (&barrier, zoom);
-#else
-    pthread_barrier_wait (&barrier);
-    if (me == 0)
-      zoom ();
-    pthread_barrier_wait (&barrier);
-#endif
+  for (int i = 0; i < MAX_ITERATIONS; i++) {
+    __m256d rc   = _mm256_mul_pd (zr, zr);
+    norm         = _mm256_fmadd_pd (zi, zi, rc);
+    __m256i mask = _mm256_andnot_si256 (
+        fini, (__m256i)_mm256_cmp_pd (norm, max_norm, _CMP_LE_OS));
+    if (_mm256_testz_si256 (mask, vrai))
+      break;
+    iter = _mm256_add_epi64 (iter, _mm256_and_si256 (mask, un));
+
+    __m256d x = _mm256_add_pd (rc, _mm256_fnmadd_pd (zi, zi, cr));
+    __m256d y = _mm256_fmadd_pd (deux, _mm256_mul_pd (zr, zi), ci);
+    zr        = x;
+    zi        = y;
+
+    __m256i boucle = _mm256_and_si256 (
+        mask, (__m256i)_mm256_and_pd (_mm256_cmp_pd (zr, sr, _CMP_EQ_OQ),
+                                      _mm256_cmp_pd (zi, si, _CMP_EQ_OQ)));
+    fini = _mm256_or_si256 (fini, boucle);
+    iter = _mm256_blendv_epi8 (iter, max_iter, boucle);
+
+    if ((i & (i + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
   }
 
-  return NULL;
+  return iter;
 }
 
-unsigned mandel_compute_thread (unsigned nb_iter)
+// Les compteurs sur 64 bits sont ramenés sur 32 bits
+TARGET_AVX2 static inline void store_iterations_double_avx2 (
+    unsigned *iterations, __m256i iter)
 {
-  char *str = getenv ("OMP_NUM_THREADS");
+  iter = _mm256_permutevar8x32_epi32 (
+      iter, _mm256_setr_epi32 (0, 2, 4, 6, 1, 3, 5, 7));
+  _mm_storeu_si128 ((__m128i *)iterations, _mm256_castsi256_si128 (iter));
+}
 
-  if (str != NULL)
-    nb_threads = atoi (str);
-  else
-    nb_threads = get_nb_cores ();
+TARGET_AVX2 static void
+compute_multiple_pixels_double_avx2 (unsigned *iterations, int i, int j)
+{
+  __m256d cr, ci;
 
-  iterations = nb_iter;
+  cr = _mm256_add_pd (_mm256_set1_pd (j), _mm256_set_pd (3, 2, 1, 0));
 
-  pthread_t pid[nb_threads - 1];
+  cr = _mm256_fmadd_pd (cr, _mm256_set1_pd (frame->dxstep),
+                        _mm256_set1_pd (frame->dleftX));
 
-  pthread_barrier_init (&barrier, NULL, nb_threads);
+  ci = _mm256_set1_pd (frame->dtopY - frame->dystep * i);
 
-  for (int i = 0; i < nb_threads - 1; i++)
-    pthread_create (&pid[i], NULL, thread_starter_bloc,
-                    (void *)(intptr_t) (i + 1));
+  store_iterations_double_avx2 (iterations,
+                                iterate_pixels_double_avx2 (cr, ci));
+}
 
-  thread_starter_bloc (0);
+TARGET_AVX2 static void
+compute_multiple_pixels_double_col_avx2 (unsigned *iterations, int i, int j)
+{
+  double ci[4];
+  __m256d cr;
 
-  for (int i = 0; i < nb_threads - 1; i++)
-    pthread_join (pid[i], NULL);
+  for (int v = 0; v < 4; v++)
+    ci[v] = frame->dtopY - frame->dystep * (i + v);
 
-  return 0;
+  cr = _mm256_fmadd_pd (_mm256_set1_pd (j), _mm256_set1_pd (frame->dxstep),
+                        _mm256_set1_pd (frame->dleftX));
+
+  store_iterations_double_avx2 (
+      iterations, iterate_pixels_double_avx2 (cr, _mm256_loadu_pd (ci)));
 }
 
-///////////////////////////// Version thread cyclic
+// En double, deux vecteurs de 4 pixels
+TARGET_AVX2 static void compute_iterations_avx2 (unsigned *iterations, int i,
+                                                 int j)
+{
+  if (frame->use_double)
+    for (int v = 0; v < 8; v += 4)
+      compute_multiple_pixels_double_avx2 (iterations + v, i, j + v);
+  else
+    compute_multiple_pixels_avx2 (iterations, i, j);
+}
 
-static void *thread_starter_cyclic (void *arg)
+TARGET_AVX2 static void compute_iterations_col_avx2 (unsigned *iterations,
+                                                     int i, int j)
 {
-  unsigned me = (unsigned)(intptr_t)arg;
+  if (frame->use_double)
+    for (int v = 0; v < 8; v += 4)
+      compute_multiple_pixels_double_col_avx2 (iterations + v, i + v, j);
+  else
+    compute_multiple_pixels_col_avx2 (iterations, i, j);
+}
 
-  PRINT_DEBUG ('t', "Thread %d/%d started\n", me, nb_threads);
+TARGET_AVX2 static void store_avx2 (uint16_t *dst, const unsigned *iterations)
+{
+  __m256i iter = _mm256_load_si256 ((const __m256i *)iterations);
 
-  for (unsigned it = 1; it <= iterations; it++) {
+  _mm_storeu_si128 ((__m128i *)dst,
+                    _mm_packus_epi32 (_mm256_castsi256_si128 (iter),
+                                      _mm256_extracti128_si256 (iter, 1)));
+}
 
-    for (unsigned line = me; line < DIM; line += nb_threads) {
-      traiter_tuile_vec (line, 0, line, DIM - 1);
-#ifdef ENABLE_MONITORING
-      monitoring_add_tile (0, line, DIM, 1, me);
+TARGET_AVX2 static void colorize_avx2 (unsigned *colors,
+                                       const uint16_t *iterations)
+{
+  __m256i iter =
+      _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *)iterations));
+
+  _mm256_storeu_si256 ((__m256i *)colors,
+                       _mm256_i32gather_epi32 ((const int *)color_lut, iter,
+                                               sizeof (unsigned)));
+}
+
+//////// AVX-512 (16 floats, 8 doubles)
+
+// Même suite d'opérations qu'iterate_pixels_avx2, voie par voie : l'image
+// est identique. Les masques remplacent les vecteurs de comparaison
+TARGET_AVX512 static __m512i iterate_pixels_avx512 (__m512 cr, __m512 ci)
+{
+  __m512 zr = _mm512_setzero_ps (), zi = zr, sr = zr, si = zr;
+  __m512 deux     = _mm512_set1_ps (2.0);
+  __m512 max_norm = _mm512_set1_ps (4.0);
+
+  __m512i un       = _mm512_set1_epi32 (1);
+  __m512i max_iter = _mm512_set1_epi32 (MAX_ITERATIONS);
+
+  __m512 xc = _mm512_sub_ps (cr, _mm512_set1_ps (0.25));
+  __m512 xb = _mm512_add_ps (cr, _mm512_set1_ps (1.0));
+  __m512 y2 = _mm512_mul_ps (ci, ci);
+  __m512 q  = _mm512_fmadd_ps (xc, xc, y2);
+  __mmask16 card = _mm512_cmp_ps_mask (
+      _mm512_mul_ps (q, _mm512_add_ps (q, xc)),
+      _mm512_mul_ps (y2, _mm512_set1_ps (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __mmask16 bulb = _mm512_cmp_ps_mask (
+      _mm512_fmadd_ps (xb, xb, y2), _mm512_set1_ps (INTERIOR_MARGIN * 0.0625),
+      _CMP_LT_OS);
+  __mmask16 fini = card | bulb;
+  __m512i iter   = _mm512_maskz_mov_epi32 (fini, max_iter);
+
+  for (int i = 0; i < MAX_ITERATIONS; i++) {
+    __m512 rc      = _mm512_mul_ps (zr, zr);
+    __m512 norm    = _mm512_fmadd_ps (zi, zi, rc);
+    __mmask16 mask =
+        _mm512_mask_cmp_ps_mask (~fini, norm, max_norm, _CMP_LE_OS);
+    if (mask == 0)
+      break;
+    iter = _mm512_mask_add_epi32 (iter, mask, iter, un);
+
+    __m512 x = _mm512_add_ps (rc, _mm512_fnmadd_ps (zi, zi, cr));
+    __m512 y = _mm512_fmadd_ps (deux, _mm512_mul_ps (zr, zi), ci);
+    zr       = x;
+    zi       = y;
+
+    __mmask16 boucle = _mm512_mask_cmp_ps_mask (mask, zr, sr, _CMP_EQ_OQ) &
+                       _mm512_cmp_ps_mask (zi, si, _CMP_EQ_OQ);
+    fini |= boucle;
+    iter = _mm512_mask_mov_epi32 (iter, boucle, max_iter);
+
+    if ((i & (i + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+  }
+
+  return iter;
+}
+
+TARGET_AVX512 static __m256i iterate_pixels_double_avx512 (__m512d cr,
+                                                           __m512d ci)
+{
+  __m512d zr = _mm512_setzero_pd (), zi = zr, sr = zr, si = zr;
+  __m512d deux     = _mm512_set1_pd (2.0);
+  __m512d max_norm = _mm512_set1_pd (4.0);
+
+  __m512i un       = _mm512_set1_epi64 (1);
+  __m512i max_iter = _mm512_set1_epi64 (MAX_ITERATIONS);
+
+  __m512d xc = _mm512_sub_pd (cr, _mm512_set1_pd (0.25));
+  __m512d xb = _mm512_add_pd (cr, _mm512_set1_pd (1.0));
+  __m512d y2 = _mm512_mul_pd (ci, ci);
+  __m512d q  = _mm512_fmadd_pd (xc, xc, y2);
+  __mmask8 card = _mm512_cmp_pd_mask (
+      _mm512_mul_pd (q, _mm512_add_pd (q, xc)),
+      _mm512_mul_pd (y2, _mm512_set1_pd (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __mmask8 bulb = _mm512_cmp_pd_mask (
+      _mm512_fmadd_pd (xb, xb, y2), _mm512_set1_pd (INTERIOR_MARGIN * 0.0625),
+      _CMP_LT_OS);
+  __mmask8 fini = card | bulb;
+  __m512i iter  = _mm512_maskz_mov_epi64 (fini, max_iter);
+
+  for (int i = 0; i < MAX_ITERATIONS; i++) {
+    __m512d rc    = _mm512_mul_pd (zr, zr);
+    __m512d norm  = _mm512_fmadd_pd (zi, zi, rc);
+    __mmask8 mask = _mm512_mask_cmp_pd_mask (~fini, norm, max_norm, _CMP_LE_OS);
+    if (mask == 0)
+      break;
+    iter = _mm512_mask_add_epi64 (iter, mask, iter, un);
+
+    __m512d x = _mm512_add_pd (rc, _mm512_fnmadd_pd (zi, zi, cr));
+    __m512d y = _mm512_fmadd_pd (deux, _mm512_mul_pd (zr, zi), ci);
+    zr        = x;
+    zi        = y;
+
+    __mmask8 boucle = _mm512_mask_cmp_pd_mask (mask, zr, sr, _CMP_EQ_OQ) &
+                      _mm512_cmp_pd_mask (zi, si, _CMP_EQ_OQ);
+    fini |= boucle;
+    iter = _mm512_mask_mov_epi64 (iter, boucle, max_iter);
+
+    if ((i & (i + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+  }
+
+  // Compteurs ramenés sur 32 bits
+  return _mm512_cvtepi64_epi32 (iter);
+}
+
+TARGET_AVX512 static void compute_iterations_avx512 (unsigned *iterations,
+                                                     int i, int j)
+{
+  if (frame->use_double)
+    for (int v = 0; v < 16; v += 8) {
+      __m512d cr = _mm512_add_pd (_mm512_set1_pd (j + v),
+                                  _mm512_setr_pd (0, 1, 2, 3, 4, 5, 6, 7));
+      cr = _mm512_fmadd_pd (cr, _mm512_set1_pd (frame->dxstep),
+                            _mm512_set1_pd (frame->dleftX));
+      __m512d ci = _mm512_set1_pd (frame->dtopY - frame->dystep * i);
+
+      _mm256_store_si256 ((__m256i *)(iterations + v),
+                          iterate_pixels_double_avx512 (cr, ci));
+    }
+  else {
+    __m512 cr = _mm512_add_ps (
+        _mm512_set1_ps (j), _mm512_setr_ps (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                            11, 12, 13, 14, 15));
+    cr = _mm512_fmadd_ps (cr, _mm512_set1_ps (frame->xstep),
+                          _mm512_set1_ps (frame->leftX));
+    __m512 ci = _mm512_set1_ps (frame->topY - frame->ystep * i);
+
+    _mm512_store_si512 (iterations, iterate_pixels_avx512 (cr, ci));
+  }
+}
+
+TARGET_AVX512 static void compute_iterations_col_avx512 (unsigned *iterations,
+                                                         int i, int j)
+{
+  if (frame->use_double) {
+    double ci[8];
+
+    for (int v = 0; v < 16; v += 8) {
+      for (int k = 0; k < 8; k++)
+        ci[k] = frame->dtopY - frame->dystep * (i + v + k);
+
+      __m512d cr =
+          _mm512_fmadd_pd (_mm512_set1_pd (j), _mm512_set1_pd (frame->dxstep),
+                           _mm512_set1_pd (frame->dleftX));
+
+      _mm256_store_si256 (
+          (__m256i *)(iterations + v),
+          iterate_pixels_double_avx512 (cr, _mm512_loadu_pd (ci)));
+    }
+  } else {
+    float ci[16];
+
+    for (int v = 0; v < 16; v++)
+      ci[v] = frame->topY - frame->ystep * (i + v);
+
+    __m512 cr =
+        _mm512_fmadd_ps (_mm512_set1_ps (j), _mm512_set1_ps (frame->xstep),
+                         _mm512_set1_ps (frame->leftX));
+
+    _mm512_store_si512 (iterations,
+                        iterate_pixels_avx512 (cr, _mm512_loadu_ps (ci)));
+  }
+}
+
+TARGET_AVX512 static void store_avx512 (uint16_t *dst,
+                                        const unsigned *iterations)
+{
+  _mm256_storeu_si256 ((__m256i *)dst,
+                       _mm512_cvtepi32_epi16 (_mm512_load_si512 (iterations)));
+}
+
+TARGET_AVX512 static void colorize_avx512 (unsigned *colors,
+                                           const uint16_t *iterations)
+{
+  __m512i iter =
+      _mm512_cvtepu16_epi32 (_mm256_loadu_si256 ((const __m256i *)iterations));
+
+  _mm512_storeu_si512 (colors, _mm512_i32gather_epi32 (iter, color_lut,
+                                                       sizeof (unsigned)));
+}
+
+//////// Sélection
+
+static const simd_level_t simd_levels[NB_ISA] = {
+    [ISA_SCALAR] = {"scalar", 1, compute_iterations_scalar,
+                    compute_iterations_scalar, store_scalar, colorize_scalar},
+    [ISA_SSE4]   = {"sse4", 4, compute_iterations_sse4,
+                    compute_iterations_col_sse4, store_sse4, colorize_sse4},
+    [ISA_AVX2]   = {"avx2", 8, compute_iterations_avx2,
+                    compute_iterations_col_avx2, store_avx2, colorize_avx2},
+    [ISA_AVX512] = {"avx512", 16, compute_iterations_avx512,
+                    compute_iterations_col_avx512, store_avx512,
+                    colorize_avx512},
+};
+
+static int isa_level             = ISA_SCALAR;
+static const simd_level_t *simd = &simd_levels[ISA_SCALAR];
+
+static bool isa_supported (int level)
+{
+  switch (level) {
+  case ISA_SSE4:
+    return __builtin_cpu_supports ("sse4.1");
+  case ISA_AVX2:
+    return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+  case ISA_AVX512:
+    return __builtin_cpu_supports ("avx512f");
+  default:
+    return true;
+  }
+}
+
+static void select_isa (void)
+{
+  if (vec_isa != NULL) {
+    for (isa_level = 0; isa_level < NB_ISA; isa_level++)
+      if (!strcmp (vec_isa, simd_levels[isa_level].name))
+        break;
+
+    if (isa_level == NB_ISA)
+      exit_with_error ("unknown ISA [%s] (scalar, sse4, avx2 or avx512)\n",
+                       vec_isa);
+    if (!isa_supported (isa_level))
+      exit_with_error ("ISA [%s] is not supported by this CPU\n", vec_isa);
+  } else
+    for (isa_level = NB_ISA - 1; !isa_supported (isa_level); isa_level--)
+      ;
+
+  simd = &simd_levels[isa_level];
+  printf ("Using ISA [%s] (%u pixels per vector)\n", simd->name,
+          simd->vec_size);
+}
+
+static void do_computation (int i, int j, int j_f)
+{
+  unsigned iterations[MAX_VEC_SIZE] __attribute__ ((aligned (64)));
+
+  simd->row (iterations, i, j);
+
+  // Le dernier vecteur d'une ligne peut dépasser de la tuile
+  if (j + simd->vec_size - 1 <= j_f)
+    simd->store (&cur_iter (i, j), iterations);
+  else
+    for (int v = 0; j + v <= j_f; v++)
+      cur_iter (i, j + v) = iterations[v];
+}
+
+static void traiter_tuile_vec (int i_d, int j_d, int i_f, int j_f)
+{
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+
+  for (int i = i_d; i <= i_f; i++)
+    for (int j = j_d; j <= j_f; j += simd->vec_size)
+      do_computation (i, j, j_f);
+}
+
+// Renvoie le nombre d'itérations effectuées avant stabilisation, ou 0
+unsigned mandel_compute_vec (unsigned nb_iter)
+{
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    // On traite toute l'image en une seule fois
+    traiter_tuile_vec (0, 0, DIM - 1, DIM - 1);
+    zoom ();
+  }
+
+  return 0;
+}
+
+#else
+
+#define traiter_tuile_vec(i_d, j_d, i_f, j_f) traiter_tuile (i_d, j_d, i_f, j_f)
+
+#endif
+
+// Colore le tampon des itérations, seulement lorsqu'une image doit être
+// affichée ou sauvegardée
+void mandel_refresh_img (void)
+{
+  if (anim.iter == NULL)
+    return;
+
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < DIM; i++) {
+    int j = 0;
+
+#ifdef ENABLE_VECTO
+    for (; j + simd->vec_size <= DIM; j += simd->vec_size)
+      simd->colorize (&cur_img (i, j), &cur_iter (i, j));
+#endif
+
+    for (; j < DIM; j++)
+      cur_img (i, j) = iteration_to_color (cur_iter (i, j));
+  }
+}
+
+///////////////////////////// Version séquentielle tuilée (tiled)
+
+static unsigned tranche = 0;
+
+static void traiter_tuile (int i_d, int j_d, int i_f, int j_f)
+{
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+
+  for (int i = i_d; i <= i_f; i++)
+    for (int j = j_d; j <= j_f; j++) {
+      unsigned n = frame->use_double ? compute_one_pixel_double (i, j)
+                                     : compute_one_pixel (i, j);
+      cur_iter (i, j) = n;
+    }
+}
+
+unsigned mandel_compute_tiled (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    // On itére sur les coordonnées des tuiles
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++)
+        traiter_tuile_vec (i * tranche /* i debut */, j * tranche /* j debut */,
+                           (i + 1) * tranche - 1 /* i fin */,
+                           (j + 1) * tranche - 1 /* j fin */);
+
+    zoom ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version thread bloc
+
+static unsigned nb_threads = 2;
+static unsigned iterations = 1;
+
+static pthread_barrier_t barrier;
+
+static void *thread_starter_bloc (void *arg)
+{
+  unsigned me    = (unsigned)(intptr_t)arg;
+  unsigned slice = DIM / nb_threads;
+  unsigned i_d   = me * slice;
+  unsigned i_f   = ((me == nb_threads - 1) ? DIM - 1 : (me + 1) * slice - 1);
+
+  PRINT_DEBUG ('t', "Thread %d/%d started, computing slice [%4u-%4u]\n", me,
+               nb_threads, i_d, i_f);
+  for (unsigned it = 1; it <= iterations; it++) {
+    traiter_tuile_vec (i_d, 0, i_f, DIM - 1);
+#ifdef ENABLE_MONITORING
+    monitoring_add_tile (0, i_d, DIM, i_f - i_d + 1, me);
+#endif
+
+#ifdef __APPLE__
+    pthread_barrier_single (&barrier, zoom);
+#else
+    pthread_barrier_wait (&barrier);
+    if (me == 0)
+      zoom ();
+    pthread_barrier_wait (&barrier);
+#endif
+  }
+
+  return NULL;
+}
+
+unsigned mandel_compute_thread (unsigned nb_iter)
+{
+  char *str = getenv ("OMP_NUM_THREADS");
+
+  if (str != NULL)
+    nb_threads = atoi (str);
+  else
+    nb_threads = get_nb_cores ();
+
+  iterations = nb_iter - skip_unseen_frames (nb_iter, zoom);
+
+  pthread_t pid[nb_threads - 1];
+
+  pthread_barrier_init (&barrier, NULL, nb_threads);
+
+  for (int i = 0; i < nb_threads - 1; i++)
+    pthread_create (&pid[i], NULL, thread_starter_bloc,
+                    (void *)(intptr_t) (i + 1));
+
+  thread_starter_bloc (0);
+
+  for (int i = 0; i < nb_threads - 1; i++)
+    pthread_join (pid[i], NULL);
+
+  return 0;
+}
+
+///////////////////////////// Version thread cyclic
+
+static void *thread_starter_cyclic (void *arg)
+{
+  unsigned me = (unsigned)(intptr_t)arg;
+
+  PRINT_DEBUG ('t', "Thread %d/%d started\n", me, nb_threads);
+
+  for (unsigned it = 1; it <= iterations; it++) {
+
+    for (unsigned line = me; line < DIM; line += nb_threads) {
+      traiter_tuile_vec (line, 0, line, DIM - 1);
+#ifdef ENABLE_MONITORING
+      monitoring_add_tile (0, line, DIM, 1, me);
 #endif
     }
 
@@ -393,7 +1248,7 @@ unsigned mandel_compute_thread_cyclic (unsigned nb_iter)
   else
     nb_threads = get_nb_cores ();
 
-  iterations = nb_iter;
+  iterations = nb_iter - skip_unseen_frames (nb_iter, zoom);
 
   pthread_t pid[nb_threads - 1];
 
@@ -447,7 +1302,7 @@ unsigned mandel_compute_thread_dyn (unsigned nb_iter)
   else
     nb_threads = get_nb_cores ();
 
-  iterations = nb_iter;
+  iterations = nb_iter - skip_unseen_frames (nb_iter, zoom);
 
   pthread_t pid[nb_threads - 1];
 
@@ -504,7 +1359,7 @@ unsigned mandel_compute_thread_dyn_tiled (unsigned nb_iter)
 
   tranche = DIM / GRAIN;
 
-  iterations = nb_iter;
+  iterations = nb_iter - skip_unseen_frames (nb_iter, zoom);
 
   pthread_t pid[nb_threads - 1];
 
@@ -528,6 +1383,8 @@ unsigned mandel_compute_omp (unsigned nb_iter)
 {
   tranche = DIM / GRAIN;
 
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
   for (unsigned it = 1; it <= nb_iter; it++) {
 
     // On itére sur les coordonnées des tuiles
@@ -549,56 +1406,790 @@ unsigned mandel_compute_omp (unsigned nb_iter)
   return 0;
 }
 
-///////////////////////////// Version utilisant un ordonnanceur maison (sched)
+///////////////////////////// Version vectorielle à recharge de voies (refill)
 
-unsigned P;
+// Dans traiter_tuile_vec, un vecteur itère jusqu'à ce que le plus lent de
+// ses pixels voisins ait terminé, et les voies déjà terminées calculent
+// pour rien. Ici, les pixels d'une tuile forment une file : dès qu'une voie
+// a terminé, son résultat est rangé et elle reçoit le pixel suivant. Deux
+// vecteurs indépendants avancent en même temps pour recouvrir la latence des
+// FMA. Chaque voie effectue exactement les mêmes opérations que dans
+// iterate_pixels_avx2 : l'image est identique à celle de traiter_tuile_vec.
+// Cette version n'existe qu'en AVX2 (utilisé aussi sur les processeurs
+// AVX-512) ; en dessous, on se rabat sur traiter_tuile_vec.
 
-void mandel_init_sched ()
-{
-  xstep = (rightX - leftX) / DIM;
-  ystep = (topY - bottomY) / DIM;
+#ifdef ENABLE_VECTO
 
-  P = scheduler_init (-1);
-}
+#define REFILL_LANES 8
+#define REFILL_VECTORS 2
+#define REFILL_MIN 4 // voies terminées avant de recharger un vecteur
 
-void mandel_finalize_sched ()
+typedef struct
 {
-  scheduler_finalize ();
-}
+  __m256 zr, zi, cr, ci, sr, si;
+  __m256i iter, fini, busy; // busy : voies qui portent un pixel
+} lanes_t;
 
-static inline void *pack (int i, int j)
+TARGET_AVX2 static inline void lanes_step (lanes_t *l)
 {
-  uint64_t x = (uint64_t)i << 32 | j;
-  return (void *)x;
+  const __m256i max_iter = _mm256_set1_epi32 (MAX_ITERATIONS);
+
+  __m256 rc   = _mm256_mul_ps (l->zr, l->zr);
+  __m256 norm = _mm256_fmadd_ps (l->zi, l->zi, rc);
+  __m256i le =
+      (__m256i)_mm256_cmp_ps (norm, _mm256_set1_ps (4.0), _CMP_LE_OS);
+  __m256i mask = _mm256_andnot_si256 (l->fini, le);
+
+  l->iter = _mm256_add_epi32 (l->iter,
+                              _mm256_and_si256 (mask, _mm256_set1_epi32 (1)));
+
+  __m256 x = _mm256_add_ps (rc, _mm256_fnmadd_ps (l->zi, l->zi, l->cr));
+  __m256 y = _mm256_fmadd_ps (_mm256_set1_ps (2.0),
+                              _mm256_mul_ps (l->zr, l->zi), l->ci);
+  l->zr    = x;
+  l->zi    = y;
+
+  __m256i boucle = _mm256_and_si256 (
+      mask, (__m256i)_mm256_and_ps (_mm256_cmp_ps (l->zr, l->sr, _CMP_EQ_OQ),
+                                    _mm256_cmp_ps (l->zi, l->si, _CMP_EQ_OQ)));
+  l->iter = _mm256_blendv_epi8 (l->iter, max_iter, boucle);
+
+  // Sauvegarde de Brent quand le compteur de la voie atteint 2^k
+  __m256i pow2 = _mm256_cmpeq_epi32 (
+      _mm256_and_si256 (l->iter,
+                        _mm256_sub_epi32 (l->iter, _mm256_set1_epi32 (1))),
+      _mm256_setzero_si256 ());
+  __m256 save = (__m256)_mm256_and_si256 (mask, pow2);
+
+  l->sr = _mm256_blendv_ps (l->sr, l->zr, save);
+  l->si = _mm256_blendv_ps (l->si, l->zi, save);
+
+  // Terminé : échappé, périodique ou au bout des itérations
+  l->fini = _mm256_or_si256 (
+      _mm256_or_si256 (l->fini, _mm256_xor_si256 (le, _mm256_set1_epi32 (-1))),
+      _mm256_or_si256 (boucle, _mm256_cmpeq_epi32 (l->iter, max_iter)));
 }
 
-static inline void unpack (void *a, int *i, int *j)
+// File des pixels d'une tuile, parcourue ligne par ligne
+typedef struct
 {
-  *i = (uint64_t)a >> 32;
-  *j = (uint64_t)a & 0xFFFFFFFF;
-}
-
-static inline unsigned cpu (int i, int j)
+  int i, j, j_d, j_f, i_f;
+} queue_t;
+
+// Range les voies terminées et les recharge avec les pixels suivants de la
+// file (pi[v], pj[v] : pixel de la voie v, pi[v] < 0 si la voie est vide).
+// Renvoie le nombre de voies occupées
+TARGET_AVX2 static int lanes_refill (lanes_t *l, int *pi, int *pj,
+                                     queue_t *file)
 {
-  return -1; // was: i % P
+  unsigned done = _mm256_movemask_ps ((__m256)l->fini);
+  unsigned iter[REFILL_LANES] __attribute__ ((aligned (32)));
+  float cr[REFILL_LANES] __attribute__ ((aligned (32)));
+  float ci[REFILL_LANES] __attribute__ ((aligned (32)));
+  int fresh[REFILL_LANES] __attribute__ ((aligned (32)));
+  int busy[REFILL_LANES] __attribute__ ((aligned (32)));
+  int nb_busy = 0;
+
+  _mm256_store_si256 ((__m256i *)iter, l->iter);
+
+  for (int v = 0; v < REFILL_LANES; v++) {
+    fresh[v] = 0;
+    cr[v] = ci[v] = 0.0;
+
+    if (done & (1 << v)) {
+      if (pi[v] >= 0)
+        cur_iter (pi[v], pj[v]) = iter[v];
+
+      if (file->i <= file->i_f) {
+        pi[v]    = file->i;
+        pj[v]    = file->j;
+        fresh[v] = -1;
+        cr[v]    = fmaf (file->j, frame->xstep, frame->leftX);
+        ci[v]    = frame->topY - frame->ystep * file->i;
+
+        if (++file->j > file->j_f) {
+          file->j = file->j_d;
+          file->i++;
+        }
+      } else
+        pi[v] = -1;
+    }
+
+    busy[v] = -(pi[v] >= 0);
+    nb_busy -= busy[v];
+  }
+
+  __m256 f    = (__m256)_mm256_load_si256 ((__m256i *)fresh);
+  __m256 zero = _mm256_setzero_ps ();
+
+  l->busy = _mm256_load_si256 ((__m256i *)busy);
+  l->cr   = _mm256_blendv_ps (l->cr, _mm256_load_ps (cr), f);
+  l->ci   = _mm256_blendv_ps (l->ci, _mm256_load_ps (ci), f);
+  l->zr   = _mm256_blendv_ps (l->zr, zero, f);
+  l->zi   = _mm256_blendv_ps (l->zi, zero, f);
+  l->sr   = _mm256_blendv_ps (l->sr, zero, f);
+  l->si   = _mm256_blendv_ps (l->si, zero, f);
+  l->iter = _mm256_andnot_si256 ((__m256i)f, l->iter);
+
+  // Les voies vides restent « terminées », les nouvelles ne le sont que si
+  // elles tombent dans la cardioïde ou le disque de période 2
+  __m256 xc   = _mm256_sub_ps (l->cr, _mm256_set1_ps (0.25));
+  __m256 xb   = _mm256_add_ps (l->cr, _mm256_set1_ps (1.0));
+  __m256 y2   = _mm256_mul_ps (l->ci, l->ci);
+  __m256 q    = _mm256_fmadd_ps (xc, xc, y2);
+  __m256 card = _mm256_cmp_ps (
+      _mm256_mul_ps (q, _mm256_add_ps (q, xc)),
+      _mm256_mul_ps (y2, _mm256_set1_ps (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __m256 bulb = _mm256_cmp_ps (_mm256_fmadd_ps (xb, xb, y2),
+                               _mm256_set1_ps (INTERIOR_MARGIN * 0.0625),
+                               _CMP_LT_OS);
+  __m256i inside =
+      _mm256_and_si256 ((__m256i)f, (__m256i)_mm256_or_ps (card, bulb));
+
+  l->fini = _mm256_blendv_epi8 (l->fini, inside, (__m256i)f);
+  l->iter = _mm256_blendv_epi8 (l->iter, _mm256_set1_epi32 (MAX_ITERATIONS),
+                                inside);
+
+  return nb_busy;
 }
 
-static inline void create_task (task_func_t t, int i, int j)
+TARGET_AVX2 static void traiter_tuile_refill_avx2 (int i_d, int j_d,
+                                                   int i_f, int j_f)
 {
-  scheduler_create_task (t, pack (i, j), cpu (i, j));
-}
+  queue_t file = {i_d, j_d, j_d, j_f, i_f};
+  int pi[REFILL_VECTORS][REFILL_LANES], pj[REFILL_VECTORS][REFILL_LANES];
+  lanes_t l[REFILL_VECTORS];
+
+  // Toutes les voies sont vides et terminées : le premier appel à
+  // lanes_refill les remplit
+  for (int k = 0; k < REFILL_VECTORS; k++) {
+    l[k].zr = l[k].zi = l[k].cr = l[k].ci = _mm256_setzero_ps ();
+    l[k].sr = l[k].si = _mm256_setzero_ps ();
+    l[k].fini         = _mm256_set1_epi32 (-1);
+    l[k].iter         = _mm256_setzero_si256 ();
+    for (int v = 0; v < REFILL_LANES; v++)
+      pi[k][v] = -1;
+  }
 
-//////// First Touch
+  for (;;) {
+    int busy = 0;
 
-static void zero_seq (int i_d, int j_d, int i_f, int j_f)
-{
+    for (int k = 0; k < REFILL_VECTORS; k++)
+      busy += lanes_refill (&l[k], pi[k], pj[k], &file);
 
-  for (int i = i_d; i <= i_f; i++)
-    for (int j = j_d; j <= j_f; j++)
-      cur_img (i, j) = 0;
+    if (busy == 0)
+      break;
+
+    // On avance jusqu'à ce qu'un vecteur ait assez de voies terminées pour
+    // que la recharge soit rentable, ou que plus rien ne reste à calculer
+    bool ready, idle;
+    do {
+      ready = false;
+      idle  = true;
+      for (int k = 0; k < REFILL_VECTORS; k++) {
+        lanes_step (&l[k]);
+
+        unsigned d = _mm256_movemask_ps ((__m256)_mm256_and_si256 (
+            l[k].fini, l[k].busy));
+        unsigned b = _mm256_movemask_ps ((__m256)l[k].busy);
+
+        ready |= __builtin_popcount (d) >= REFILL_MIN;
+        idle &= (d == b);
+      }
+    } while (!ready && !idle);
+  }
 }
 
-static void first_touch_task (void *p, unsigned proc)
+static void traiter_tuile_refill (int i_d, int j_d, int i_f, int j_f)
+{
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+
+  if (frame->use_double || isa_level < ISA_AVX2)
+    traiter_tuile_vec (i_d, j_d, i_f, j_f);
+  else
+    traiter_tuile_refill_avx2 (i_d, j_d, i_f, j_f);
+}
+
+#else
+
+#define traiter_tuile_refill(i_d, j_d, i_f, j_f)                               \
+  traiter_tuile_vec (i_d, j_d, i_f, j_f)
+
+#endif
+
+unsigned mandel_compute_refill (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+#pragma omp parallel for collapse(2) schedule(runtime)
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++) {
+        traiter_tuile_refill (i * tranche /* i debut */,
+                              j * tranche /* j debut */,
+                              (i + 1) * tranche - 1 /* i fin */,
+                              (j + 1) * tranche - 1 /* j fin */);
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                             omp_get_thread_num ());
+#endif
+      }
+
+    zoom ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version pipeline d'images (pipeline)
+
+// Une image ne dépend de la précédente que par son cadre, que zoom fait
+// avancer de façon déterministe : on calcule d'avance le cadre de chacune
+// des nb_iter images de l'appel, et les threads prennent les tuiles dans
+// l'ordre des images, sans barrière entre deux images. Les premières tuiles
+// de l'image k + 1 démarrent donc pendant que les dernières de l'image k se
+// terminent. Au plus pipe_depth images sont en vol, chacune dans son propre
+// tampon : avant de traiter une tuile de l'image k, un thread attend que
+// l'image k - pipe_depth, dont il réutilise le tampon, soit terminée
+// (« --arg depth=N », 2 par défaut)
+
+#define PIPE_DEFAULT_DEPTH 2
+
+static unsigned pipe_depth    = PIPE_DEFAULT_DEPTH;
+static uint16_t **pipe_buffer = NULL; // pipe_buffer[0] est anim.iter
+static frame_t *pipe_frames   = NULL;
+static atomic_uint *pipe_done = NULL; // tuiles terminées, par image
+static atomic_uint pipe_next  = 0;    // prochaine tuile à distribuer
+
+void mandel_init_pipeline ()
+{
+  mandel_init ();
+
+  pipe_depth = MAX (mandel_option_value ("depth", PIPE_DEFAULT_DEPTH), 1);
+
+  PRINT_DEBUG ('c', "Pipeline depth: %u\n", pipe_depth);
+}
+
+void mandel_finalize_pipeline ()
+{
+  if (pipe_buffer != NULL) {
+    for (unsigned b = 1; b < pipe_depth; b++)
+      free (pipe_buffer[b]);
+    free (pipe_buffer);
+    pipe_buffer = NULL;
+  }
+
+  mandel_finalize ();
+}
+
+static void pipe_wait_frame (unsigned f, unsigned nb_tiles)
+{
+  while (atomic_load_explicit (&pipe_done[f], memory_order_acquire) <
+         nb_tiles)
+    sched_yield ();
+}
+
+unsigned mandel_compute_pipeline (unsigned nb_iter)
+{
+  const unsigned nb_tiles = GRAIN * GRAIN;
+
+  tranche = DIM / GRAIN;
+
+  if (pipe_buffer == NULL) {
+    pipe_buffer = malloc (pipe_depth * sizeof (uint16_t *));
+    for (unsigned b = 1; b < pipe_depth; b++)
+      pipe_buffer[b] = calloc (DIM * DIM, sizeof (uint16_t));
+  }
+  pipe_buffer[0] = anim.iter;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  // Cadres de toutes les images de l'appel, par la même récurrence que les
+  // autres variantes (à l'arrondi près, les images sont donc identiques)
+  pipe_frames = malloc (nb_iter * sizeof (frame_t));
+  pipe_done   = malloc (nb_iter * sizeof (atomic_uint));
+
+  for (unsigned f = 0; f < nb_iter; f++) {
+    pipe_frames[f]      = anim;
+    pipe_frames[f].iter = pipe_buffer[f % pipe_depth];
+    atomic_init (&pipe_done[f], 0);
+    zoom ();
+  }
+  atomic_init (&pipe_next, 0);
+
+#pragma omp parallel
+  {
+    for (unsigned t = atomic_fetch_add (&pipe_next, 1);
+         t < nb_iter * nb_tiles; t = atomic_fetch_add (&pipe_next, 1)) {
+      unsigned f = t / nb_tiles;
+      int i      = (t % nb_tiles) / GRAIN;
+      int j      = (t % nb_tiles) % GRAIN;
+
+      if (f >= pipe_depth)
+        pipe_wait_frame (f - pipe_depth, nb_tiles);
+
+      frame = &pipe_frames[f];
+
+      traiter_tuile_vec (i * tranche /* i debut */, j * tranche /* j debut */,
+                         (i + 1) * tranche - 1 /* i fin */,
+                         (j + 1) * tranche - 1 /* j fin */);
+#ifdef ENABLE_MONITORING
+      monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                           omp_get_thread_num ());
+#endif
+
+      atomic_fetch_add_explicit (&pipe_done[f], 1, memory_order_release);
+    }
+
+    frame = &anim;
+  }
+
+  // La dernière image devient celle de l'animation
+  if (nb_iter > 0) {
+    unsigned last = (nb_iter - 1) % pipe_depth;
+
+    anim.iter         = pipe_buffer[last];
+    pipe_buffer[last] = pipe_buffer[0];
+    pipe_buffer[0]    = anim.iter;
+  }
+
+  free (pipe_frames);
+  free (pipe_done);
+  pipe_frames = NULL;
+  pipe_done   = NULL;
+
+  return 0;
+}
+
+///////////////////////////// Version à répartition équilibrée (balanced)
+
+// D'une image à la suivante, le coût des tuiles varie peu : on mesure celui
+// de chaque tuile (la somme des itérations de ses pixels) et on s'en sert
+// pour répartir statiquement les tuiles de l'image suivante. Les tuiles sont
+// rangées le long d'un parcours en serpentin, et chaque thread en reçoit une
+// portion contiguë dont le coût cumulé est proche de la moyenne. On garde
+// ainsi la localité d'un ordonnancement statique (un thread retrouve à peu
+// près les mêmes tuiles d'une image à l'autre), sans le déséquilibre de
+// tranches égales
+
+static uint64_t *bal_cost  = NULL; // coût de chaque tuile à l'image précédente
+static unsigned *bal_order = NULL; // tuiles dans l'ordre du parcours
+static unsigned *bal_cut   = NULL; // le thread p traite les rangs
+                                   // bal_cut[p] .. bal_cut[p + 1] - 1
+
+void mandel_init_balanced ()
+{
+  mandel_init ();
+
+  bal_cost  = malloc (GRAIN * GRAIN * sizeof (uint64_t));
+  bal_order = malloc (GRAIN * GRAIN * sizeof (unsigned));
+  bal_cut   = malloc ((omp_get_max_threads () + 1) * sizeof (unsigned));
+
+  // En serpentin, deux tuiles consécutives du parcours sont toujours voisines
+  for (int i = 0; i < GRAIN; i++)
+    for (int j = 0; j < GRAIN; j++) {
+      bal_order[i * GRAIN + j] = i * GRAIN + (i % 2 ? GRAIN - 1 - j : j);
+      bal_cost[i * GRAIN + j]  = 1; // Coûts inconnus : découpage uniforme
+    }
+}
+
+void mandel_finalize_balanced ()
+{
+  free (bal_cost);
+  free (bal_order);
+  free (bal_cut);
+
+  mandel_finalize ();
+}
+
+// Coupe le parcours en nb_threads portions de coûts aussi proches que
+// possible : une tuile revient au thread dans la part duquel tombe le milieu
+// de son coût
+static void balanced_cuts (unsigned nb_threads)
+{
+  const unsigned nb_tiles = GRAIN * GRAIN;
+  uint64_t total = 0, prefix = 0;
+  unsigned k = 0;
+
+  for (unsigned t = 0; t < nb_tiles; t++)
+    total += bal_cost[t];
+
+  bal_cut[0] = 0;
+  for (unsigned p = 1; p < nb_threads; p++) {
+    while (k < nb_tiles &&
+           prefix + bal_cost[bal_order[k]] / 2 < total * p / nb_threads)
+      prefix += bal_cost[bal_order[k++]];
+    bal_cut[p] = k;
+  }
+  bal_cut[nb_threads] = nb_tiles;
+}
+
+// Coût de la tuile qui vient d'être calculée. On compte aussi un par pixel,
+// pour que les tuiles vides ne paraissent pas gratuites
+static uint64_t tile_cost (int i_d, int j_d, int i_f, int j_f)
+{
+  uint64_t sum = (uint64_t)(i_f - i_d + 1) * (j_f - j_d + 1);
+
+  for (int i = i_d; i <= i_f; i++)
+    for (int j = j_d; j <= j_f; j++)
+      sum += cur_iter (i, j);
+
+  return sum;
+}
+
+unsigned mandel_compute_balanced (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+#pragma omp parallel
+    {
+      unsigned me = omp_get_thread_num ();
+
+#pragma omp single
+      balanced_cuts (omp_get_num_threads ());
+
+      for (unsigned k = bal_cut[me]; k < bal_cut[me + 1]; k++) {
+        int i = bal_order[k] / GRAIN;
+        int j = bal_order[k] % GRAIN;
+
+        traiter_tuile_vec (i * tranche /* i debut */, j * tranche /* j debut */,
+                           (i + 1) * tranche - 1 /* i fin */,
+                           (j + 1) * tranche - 1 /* j fin */);
+
+        bal_cost[bal_order[k]] =
+            tile_cost (i * tranche, j * tranche, (i + 1) * tranche - 1,
+                       (j + 1) * tranche - 1);
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (j * tranche, i * tranche, tranche, tranche, me);
+#endif
+      }
+    }
+
+    zoom ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version à découpage adaptatif (adapt)
+
+// Avec un GRAIN fixe, quelques tuiles au bord de l'ensemble coûtent cent fois
+// plus que les autres et laissent des cœurs inoccupés en fin d'image. Ici,
+// chaque tuile est une tâche OpenMP qui estime d'abord son coût en sondant
+// une grille clairsemée de pixels : si l'estimation dépasse le seuil, la
+// tuile est découpée en quatre sous-tâches, sans descendre sous une taille
+// minimale (« --arg min=N », 16 par défaut). Le seuil vise
+// ADAPT_TASKS_PER_THREAD tâches par thread, d'après le coût total mesuré à
+// l'image précédente (à la première image, on ne découpe rien) : les petites
+// tuiles ne servent qu'aux régions coûteuses
+
+#define ADAPT_DEFAULT_MIN 16
+#define ADAPT_PROBES 4 // ADAPT_PROBES x ADAPT_PROBES pixels sondés par tuile
+#define ADAPT_TASKS_PER_THREAD 16
+
+static unsigned adapt_min       = ADAPT_DEFAULT_MIN;
+static uint64_t adapt_threshold = UINT64_MAX;
+static uint64_t adapt_total     = 0;
+
+void mandel_init_adapt ()
+{
+  mandel_init ();
+
+  adapt_min = MAX (mandel_option_value ("min", ADAPT_DEFAULT_MIN), 1);
+
+  PRINT_DEBUG ('c', "Minimal tile size: %u\n", adapt_min);
+}
+
+// Coût estimé de la tuile, dans la même unité que tile_cost
+static uint64_t probe_cost (int i_d, int j_d, int h, int w)
+{
+  uint64_t sum = 0;
+
+  for (int a = 0; a < ADAPT_PROBES; a++)
+    for (int b = 0; b < ADAPT_PROBES; b++) {
+      int i = i_d + (2 * a + 1) * h / (2 * ADAPT_PROBES);
+      int j = j_d + (2 * b + 1) * w / (2 * ADAPT_PROBES);
+
+      sum += 1 + (frame->use_double ? compute_one_pixel_double (i, j)
+                                    : compute_one_pixel (i, j));
+    }
+
+  return sum * h * w / (ADAPT_PROBES * ADAPT_PROBES);
+}
+
+static void adapt_tile (int i_d, int j_d, int h, int w)
+{
+  if (adapt_threshold != UINT64_MAX && MIN (h, w) >= 2 * adapt_min &&
+      probe_cost (i_d, j_d, h, w) > adapt_threshold) {
+    int h2 = h / 2, w2 = w / 2;
+
+#pragma omp task
+    adapt_tile (i_d, j_d, h2, w2);
+#pragma omp task
+    adapt_tile (i_d, j_d + w2, h2, w - w2);
+#pragma omp task
+    adapt_tile (i_d + h2, j_d, h - h2, w2);
+#pragma omp task
+    adapt_tile (i_d + h2, j_d + w2, h - h2, w - w2);
+
+    return;
+  }
+
+  traiter_tuile_vec (i_d, j_d, i_d + h - 1, j_d + w - 1);
+
+  uint64_t cost = tile_cost (i_d, j_d, i_d + h - 1, j_d + w - 1);
+
+#pragma omp atomic
+  adapt_total += cost;
+
+#ifdef ENABLE_MONITORING
+  monitoring_add_tile (j_d, i_d, w, h, omp_get_thread_num ());
+#endif
+}
+
+unsigned mandel_compute_adapt (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    adapt_total = 0;
+
+#pragma omp parallel
+#pragma omp single
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++)
+#pragma omp task
+        adapt_tile (i * tranche, j * tranche, tranche, tranche);
+
+    adapt_threshold =
+        adapt_total / (ADAPT_TASKS_PER_THREAD * omp_get_max_threads ());
+
+    zoom ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version progressive (progressive)
+
+// En mode graphique, la boucle principale reste bloquée dans the_compute
+// jusqu'à ce que l'image soit calculée en pleine résolution, ce qui est long
+// pour un grand DIM. Ici, l'image affichée est calculée en passes : un pixel
+// sur 8 dans chaque direction, puis sur 4, sur 2 et enfin tous. Chaque passe
+// ne calcule que les pixels que les précédentes n'ont pas vus, et recopie
+// chacun d'eux sur son bloc pour donner un aperçu. Entre deux passes, si un
+// événement est en attente, on rend la main à la boucle principale, qui le
+// traite et affiche l'aperçu : l'appel suivant reprend l'image là où elle en
+// était, puis continue avec les images restantes.
+//
+// Une passe calcule une grille dont le pas est une puissance de 2, avec les
+// noyaux habituels appliqués à un cadre dont le pas est multiplié d'autant.
+// Le produit pas x indice est alors exactement le même, et l'image finale
+// identique à celle des autres variantes
+
+#define PROG_COARSEST 8
+
+static unsigned prog_stride = 0; // pas de la prochaine passe, 0 entre deux
+                                 // images
+
+#ifdef ENABLE_VECTO
+#define PROG_MAX_VEC_SIZE MAX_VEC_SIZE
+#define prog_vec_size simd->vec_size
+#define prog_row_kernel simd->row
+#define prog_col_kernel simd->col
+#else
+#define PROG_MAX_VEC_SIZE 1
+#define prog_vec_size 1
+
+static void prog_one_pixel (unsigned *iterations, int i, int j)
+{
+  iterations[0] = frame->use_double ? compute_one_pixel_double (i, j)
+                                    : compute_one_pixel (i, j);
+}
+
+#define prog_row_kernel prog_one_pixel
+#define prog_col_kernel prog_one_pixel
+#endif
+
+// Pixels (i, j) de la ligne i, pour j multiple de dj
+static void prog_row (int i, int dj)
+{
+  unsigned iterations[PROG_MAX_VEC_SIZE] __attribute__ ((aligned (64)));
+  const unsigned vec = prog_vec_size;
+  const int n        = (DIM + dj - 1) / dj;
+  frame_t sub        = anim;
+
+  sub.xstep *= dj;
+  sub.dxstep *= dj;
+  frame = &sub;
+
+  for (int j = 0; j < n; j += vec) {
+    prog_row_kernel (iterations, i, j);
+    for (int v = 0; v < vec && j + v < n; v++)
+      anim.iter[i * DIM + (j + v) * dj] = iterations[v];
+  }
+
+  frame = &anim;
+}
+
+// Pixels (i, j) de la colonne j, pour i multiple de di
+static void prog_col (int j, int di)
+{
+  unsigned iterations[PROG_MAX_VEC_SIZE] __attribute__ ((aligned (64)));
+  const unsigned vec = prog_vec_size;
+  const int n        = (DIM + di - 1) / di;
+  frame_t sub        = anim;
+
+  sub.ystep *= di;
+  sub.dystep *= di;
+  frame = &sub;
+
+  for (int i = 0; i < n; i += vec) {
+    prog_col_kernel (iterations, i, j);
+    for (int v = 0; v < vec && i + v < n; v++)
+      anim.iter[(i + v) * di * DIM + j] = iterations[v];
+  }
+
+  frame = &anim;
+}
+
+// Passe de pas s : les pixels dont les deux coordonnées sont multiples de s,
+// sauf ceux de la passe précédente (multiples de 2s)
+static void prog_pass (int s)
+{
+  if (s == PROG_COARSEST) {
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < DIM; i += s)
+      prog_row (i, s);
+  } else {
+#pragma omp parallel
+    {
+      // Lignes d'indice impair (en unités de s) : toutes les colonnes
+#pragma omp for schedule(dynamic) nowait
+      for (int i = s; i < DIM; i += 2 * s)
+        prog_row (i, s);
+
+      // Lignes d'indice pair : seulement les colonnes d'indice impair
+#pragma omp for schedule(dynamic)
+      for (int j = s; j < DIM; j += 2 * s)
+        prog_col (j, 2 * s);
+    }
+  }
+
+  if (s == 1)
+    return;
+
+  // Aperçu : chaque pixel calculé est recopié sur son bloc s x s
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < DIM; i++)
+    for (int j = 0; j < DIM; j++)
+      cur_iter (i, j) = cur_iter (i - i % s, j - j % s);
+}
+
+unsigned mandel_compute_progressive (unsigned nb_iter)
+{
+  unsigned passes = 0;
+
+  // Une image en cours compte parmi celles de l'appel
+  if (prog_stride == 0)
+    nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    if (prog_stride == 0) {
+      // Les images qui ne seront pas affichées sont calculées directement en
+      // pleine résolution
+      if (it < nb_iter) {
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < DIM; i++)
+          prog_row (i, 1);
+
+        zoom ();
+        continue;
+      }
+
+      prog_stride = PROG_COARSEST;
+    }
+
+    for (; prog_stride > 0; prog_stride /= 2, passes++) {
+      if (passes > 0 && graphics_events_pending ()) {
+        unfinished_frames = nb_iter - it + 1;
+        return 0;
+      }
+
+      prog_pass (prog_stride);
+    }
+
+    zoom ();
+  }
+
+  unfinished_frames = 0;
+
+  return 0;
+}
+
+///////////////////////////// Version utilisant un ordonnanceur maison (sched)
+
+unsigned P;
+
+void mandel_init_sched ()
+{
+  mandel_init ();
+
+  P = scheduler_init (-1);
+}
+
+void mandel_finalize_sched ()
+{
+  scheduler_finalize ();
+  mandel_finalize ();
+}
+
+static inline void *pack (int i, int j)
+{
+  uint64_t x = (uint64_t)i << 32 | j;
+  return (void *)x;
+}
+
+static inline void unpack (void *a, int *i, int *j)
+{
+  *i = (uint64_t)a >> 32;
+  *j = (uint64_t)a & 0xFFFFFFFF;
+}
+
+static inline unsigned cpu (int i, int j)
+{
+  return -1; // was: i % P
+}
+
+static inline void create_task (task_func_t t, int i, int j)
+{
+  scheduler_create_task (t, pack (i, j), cpu (i, j));
+}
+
+//////// First Touch
+
+static void zero_seq (int i_d, int j_d, int i_f, int j_f)
+{
+
+  for (int i = i_d; i <= i_f; i++)
+    for (int j = j_d; j <= j_f; j++) {
+      cur_img (i, j)  = 0;
+      cur_iter (i, j) = 0;
+    }
+}
+
+static void first_touch_task (void *p, unsigned proc)
 {
   int i, j;
 
@@ -614,6 +2205,8 @@ void mandel_ft_sched (void)
 {
   tranche = DIM / GRAIN;
 
+  iter_img_alloc ();
+
   for (int i = 0; i < GRAIN; i++)
     for (int j = 0; j < GRAIN; j++)
       create_task (first_touch_task, i, j);
@@ -643,6 +2236,8 @@ unsigned mandel_compute_sched (unsigned nb_iter)
 {
   tranche = DIM / GRAIN;
 
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
   for (unsigned it = 1; it <= nb_iter; it++) {
 
     for (int i = 0; i < GRAIN; i++)
@@ -657,15 +2252,572 @@ unsigned mandel_compute_sched (unsigned nb_iter)
   return 0;
 }
 
+///////////////////////////// Version par perturbation (perturb)
+
+// En simple précision, le pas entre deux pixels devient trop petit après
+// quelques centaines d'images et le zoom « pixelise ». On calcule donc une
+// orbite de référence Z_n au centre du cadre (qui ne bouge pas pendant le
+// zoom) en long double, puis chaque pixel c = C + dc ne calcule que l'écart
+// d_n = z_n - Z_n, en double :
+//
+//   d_{n+1} = 2 Z_n d_n + d_n^2 + dc
+//
+// Les écarts restent de l'ordre de dc, représentable jusqu'à 1e-300. Lorsque
+// |z_n| devient plus petit que |d_n| (ou que la référence s'échappe avant le
+// pixel), la précision relative de d_n se perd : on « rebase » alors le pixel
+// sur le début de l'orbite de référence (d = z, n = 0), ce qui élimine les
+// glitches sans calculer de nouvelle référence.
+//
+// Le centre ne bougeant pas, l'orbite de référence est calculée une fois pour
+// toutes. Les raccourcis de l'intérieur de l'ensemble s'appliquent aussi :
+// test des bulbes sur C + dc, et détection de périodicité sur z = Z_n + d_n.
+// Avec AVX2 (resp. AVX-512), 4 (resp. 8) pixels sont calculés à la fois,
+// chacun avec son propre indice n dans l'orbite de référence et ses propres
+// rebasements.
+
+static long double center_x, center_y, perturb_xstep, perturb_ystep;
+// Une case de plus que l'orbite : les noyaux vectoriels lisent Z_{m + 1} avant
+// de savoir si le pixel est rebasé
+static double ref_r[MAX_ITERATIONS + 2], ref_i[MAX_ITERATIONS + 2];
+static unsigned ref_len;
+
+static void compute_reference_orbit (void)
+{
+  long double zr = 0.0L, zi = 0.0L;
+
+  for (ref_len = 0; ref_len < MAX_ITERATIONS; ref_len++) {
+    ref_r[ref_len] = zr;
+    ref_i[ref_len] = zi;
+
+    if (zr * zr + zi * zi > 4.0L)
+      break;
+
+    long double twoxy = 2.0L * zr * zi;
+    zr                = zr * zr - zi * zi + center_x;
+    zi                = twoxy + center_y;
+  }
+
+  ref_r[ref_len] = zr;
+  ref_i[ref_len] = zi;
+}
+
+void mandel_init_perturb ()
+{
+  mandel_init ();
+
+  center_x      = ((long double)anim.leftX + anim.rightX) / 2;
+  center_y      = ((long double)anim.topY + anim.bottomY) / 2;
+  perturb_xstep = ((long double)anim.rightX - anim.leftX) / DIM;
+  perturb_ystep = ((long double)anim.topY - anim.bottomY) / DIM;
+
+  compute_reference_orbit ();
+}
+
+static ALWAYS_INLINE unsigned compute_one_pixel_perturb_body (int i, int j)
+{
+  double dcr = (j - (int)DIM / 2) * (double)perturb_xstep;
+  double dci = ((int)DIM / 2 - i) * (double)perturb_ystep;
+  double dr = 0.0, di = 0.0;
+  double sr = 4.0, si = 4.0; // aucun z non échappé ne vaut (4, 4)
+  unsigned m = 0;
+  int iter;
+
+  if (in_main_bulbs ((double)center_x + dcr, (double)center_y + dci))
+    return MAX_ITERATIONS;
+
+  for (iter = 0; iter < MAX_ITERATIONS; iter++) {
+    double zr = ref_r[m] + dr;
+    double zi = ref_i[m] + di;
+    double z2 = zr * zr + zi * zi;
+
+    if (z2 > 4.0)
+      break;
+
+    if (zr == sr && zi == si)
+      return MAX_ITERATIONS;
+
+    if ((iter & (iter + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+
+    // Glitch : z est plus proche de 0 que l'écart, ou la référence s'est
+    // échappée avant le pixel
+    if (z2 < dr * dr + di * di || m == ref_len) {
+      dr = zr;
+      di = zi;
+      m  = 0;
+    }
+
+    double nr = 2.0 * (ref_r[m] * dr - ref_i[m] * di) + dr * dr - di * di;
+    double ni = 2.0 * (ref_r[m] * di + ref_i[m] * dr) + 2.0 * dr * di;
+
+    dr = nr + dcr;
+    di = ni + dci;
+    m++;
+  }
+
+  return iter;
+}
+
+FMA_DISPATCH (compute_one_pixel_perturb)
+
+#ifdef ENABLE_VECTO
+
+// Pixels (i, j) à (i, j + 3). Les voies suivent chacune leur propre indice m
+// dans l'orbite de référence, lue par gather
+TARGET_AVX2 static void compute_multiple_pixels_perturb_avx2 (
+    unsigned *iterations, int i, int j)
+{
+  __m256d dcr = _mm256_mul_pd (
+      _mm256_set_pd (j + 3 - (int)DIM / 2, j + 2 - (int)DIM / 2,
+                     j + 1 - (int)DIM / 2, j - (int)DIM / 2),
+      _mm256_set1_pd ((double)perturb_xstep));
+  __m256d dci  = _mm256_set1_pd (((int)DIM / 2 - i) * (double)perturb_ystep);
+  __m256d zero = _mm256_setzero_pd ();
+
+  __m256i un       = _mm256_set1_epi64x (1);
+  __m256i vrai     = _mm256_set1_epi64x (-1);
+  __m256i len      = _mm256_set1_epi64x (ref_len);
+  __m256i max_iter = _mm256_set1_epi64x (MAX_ITERATIONS);
+
+  // Même test que in_main_bulbs
+  __m256d cr   = _mm256_add_pd (_mm256_set1_pd ((double)center_x), dcr);
+  __m256d ci   = _mm256_add_pd (_mm256_set1_pd ((double)center_y), dci);
+  __m256d xc   = _mm256_sub_pd (cr, _mm256_set1_pd (0.25));
+  __m256d xb   = _mm256_add_pd (cr, _mm256_set1_pd (1.0));
+  __m256d y2   = _mm256_mul_pd (ci, ci);
+  __m256d q    = _mm256_fmadd_pd (xc, xc, y2);
+  __m256d card = _mm256_cmp_pd (
+      _mm256_mul_pd (q, _mm256_add_pd (q, xc)),
+      _mm256_mul_pd (y2, _mm256_set1_pd (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __m256d bulb = _mm256_cmp_pd (_mm256_fmadd_pd (xb, xb, y2),
+                                _mm256_set1_pd (INTERIOR_MARGIN * 0.0625),
+                                _CMP_LT_OS);
+
+  // Voies encore en cours, et voies arrêtées par un raccourci (bulbe ou
+  // périodicité), qui vaudront MAX_ITERATIONS
+  __m256i interieur = (__m256i)_mm256_or_pd (card, bulb);
+  __m256i actif     = _mm256_andnot_si256 (interieur, vrai);
+  __m256i iter      = _mm256_setzero_si256 ();
+
+  // (rr, ri) = Z_m, lu pour l'itération suivante pendant le calcul de
+  // l'itération courante : le gather ne dépend que de m, et le rebasement
+  // (qui ramène m à 0 puis 1) est appliqué après coup
+  __m256d ref1r = _mm256_set1_pd (ref_r[1]), ref1i = _mm256_set1_pd (ref_i[1]);
+  __m256d dr = zero, di = zero, rr = zero, ri = zero;
+  __m256d sr = _mm256_set1_pd (4.0), si = sr;
+  __m256i m = _mm256_setzero_si256 ();
+
+  for (int n = 0; n < MAX_ITERATIONS; n++) {
+    __m256d zr = _mm256_add_pd (rr, dr);
+    __m256d zi = _mm256_add_pd (ri, di);
+    __m256d z2 = _mm256_fmadd_pd (zi, zi, _mm256_mul_pd (zr, zr));
+
+    actif = _mm256_and_si256 (
+        actif, (__m256i)_mm256_cmp_pd (z2, _mm256_set1_pd (4.0), _CMP_LE_OS));
+    if (_mm256_testz_si256 (actif, actif))
+      break;
+    iter = _mm256_sub_epi64 (iter, actif);
+
+    __m256i boucle = _mm256_and_si256 (
+        actif, (__m256i)_mm256_and_pd (_mm256_cmp_pd (zr, sr, _CMP_EQ_OQ),
+                                       _mm256_cmp_pd (zi, si, _CMP_EQ_OQ)));
+    interieur = _mm256_or_si256 (interieur, boucle);
+    actif     = _mm256_andnot_si256 (boucle, actif);
+
+    if ((n & (n + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+
+    __m256i m1  = _mm256_add_epi64 (m, un);
+    __m256d nrr = _mm256_i64gather_pd (ref_r, m1, sizeof (double));
+    __m256d nri = _mm256_i64gather_pd (ref_i, m1, sizeof (double));
+
+    // d = (2 Z + d) d + dc = (Z + z) d + dc et, pour les voies rebasées,
+    // d = z^2 + dc (Z_0 = 0) : les deux sont calculés sans attendre le test
+    // de rebasement
+    __m256d wr = _mm256_add_pd (rr, zr);
+    __m256d wi = _mm256_add_pd (ri, zi);
+    __m256d pr = _mm256_fmsub_pd (wr, dr, _mm256_fmsub_pd (wi, di, dcr));
+    __m256d pi = _mm256_fmadd_pd (wr, di, _mm256_fmadd_pd (wi, dr, dci));
+    __m256d qr = _mm256_fmsub_pd (zr, zr, _mm256_fmsub_pd (zi, zi, dcr));
+    __m256d qi = _mm256_fmadd_pd (_mm256_add_pd (zr, zr), zi, dci);
+
+    __m256d d2     = _mm256_fmadd_pd (di, di, _mm256_mul_pd (dr, dr));
+    __m256d rebase = _mm256_or_pd (_mm256_cmp_pd (z2, d2, _CMP_LT_OS),
+                                   (__m256d)_mm256_cmpeq_epi64 (m, len));
+
+    dr = _mm256_blendv_pd (pr, qr, rebase);
+    di = _mm256_blendv_pd (pi, qi, rebase);
+    m  = _mm256_blendv_epi8 (m1, un, (__m256i)rebase);
+    rr = _mm256_blendv_pd (nrr, ref1r, rebase);
+    ri = _mm256_blendv_pd (nri, ref1i, rebase);
+  }
+
+  iter = _mm256_blendv_epi8 (iter, max_iter, interieur);
+
+  store_iterations_double_avx2 (iterations, iter);
+}
+
+// Pixels (i, j) à (i, j + 7), même algorithme avec des masques
+TARGET_AVX512 static void compute_multiple_pixels_perturb_avx512 (
+    unsigned *iterations, int i, int j)
+{
+  __m512d dcr = _mm512_mul_pd (
+      _mm512_add_pd (_mm512_set1_pd (j - (int)DIM / 2),
+                     _mm512_setr_pd (0, 1, 2, 3, 4, 5, 6, 7)),
+      _mm512_set1_pd ((double)perturb_xstep));
+  __m512d dci  = _mm512_set1_pd (((int)DIM / 2 - i) * (double)perturb_ystep);
+  __m512d zero = _mm512_setzero_pd ();
+
+  __m512i un       = _mm512_set1_epi64 (1);
+  __m512i len      = _mm512_set1_epi64 (ref_len);
+  __m512i max_iter = _mm512_set1_epi64 (MAX_ITERATIONS);
+
+  __m512d cr = _mm512_add_pd (_mm512_set1_pd ((double)center_x), dcr);
+  __m512d ci = _mm512_add_pd (_mm512_set1_pd ((double)center_y), dci);
+  __m512d xc = _mm512_sub_pd (cr, _mm512_set1_pd (0.25));
+  __m512d xb = _mm512_add_pd (cr, _mm512_set1_pd (1.0));
+  __m512d y2 = _mm512_mul_pd (ci, ci);
+  __m512d q  = _mm512_fmadd_pd (xc, xc, y2);
+  __mmask8 card = _mm512_cmp_pd_mask (
+      _mm512_mul_pd (q, _mm512_add_pd (q, xc)),
+      _mm512_mul_pd (y2, _mm512_set1_pd (INTERIOR_MARGIN * 0.25)), _CMP_LT_OS);
+  __mmask8 bulb = _mm512_cmp_pd_mask (
+      _mm512_fmadd_pd (xb, xb, y2), _mm512_set1_pd (INTERIOR_MARGIN * 0.0625),
+      _CMP_LT_OS);
+  __mmask8 interieur = card | bulb;
+  __mmask8 actif     = ~interieur;
+  __m512i iter       = _mm512_setzero_si512 ();
+
+  __m512d ref1r = _mm512_set1_pd (ref_r[1]), ref1i = _mm512_set1_pd (ref_i[1]);
+  __m512d dr = zero, di = zero, rr = zero, ri = zero;
+  __m512d sr = _mm512_set1_pd (4.0), si = sr;
+  __m512i m = _mm512_setzero_si512 ();
+
+  for (int n = 0; n < MAX_ITERATIONS; n++) {
+    __m512d zr = _mm512_add_pd (rr, dr);
+    __m512d zi = _mm512_add_pd (ri, di);
+    __m512d z2 = _mm512_fmadd_pd (zi, zi, _mm512_mul_pd (zr, zr));
+
+    actif = _mm512_mask_cmp_pd_mask (actif, z2, _mm512_set1_pd (4.0),
+                                     _CMP_LE_OS);
+    if (actif == 0)
+      break;
+    iter = _mm512_mask_add_epi64 (iter, actif, iter, un);
+
+    __mmask8 boucle = _mm512_mask_cmp_pd_mask (actif, zr, sr, _CMP_EQ_OQ) &
+                      _mm512_cmp_pd_mask (zi, si, _CMP_EQ_OQ);
+    interieur |= boucle;
+    actif &= ~boucle;
+
+    if ((n & (n + 1)) == 0) {
+      sr = zr;
+      si = zi;
+    }
+
+    __m512i m1  = _mm512_add_epi64 (m, un);
+    __m512d nrr = _mm512_i64gather_pd (m1, ref_r, sizeof (double));
+    __m512d nri = _mm512_i64gather_pd (m1, ref_i, sizeof (double));
+
+    __m512d wr = _mm512_add_pd (rr, zr);
+    __m512d wi = _mm512_add_pd (ri, zi);
+    __m512d pr = _mm512_fmsub_pd (wr, dr, _mm512_fmsub_pd (wi, di, dcr));
+    __m512d pi = _mm512_fmadd_pd (wr, di, _mm512_fmadd_pd (wi, dr, dci));
+    __m512d qr = _mm512_fmsub_pd (zr, zr, _mm512_fmsub_pd (zi, zi, dcr));
+    __m512d qi = _mm512_fmadd_pd (_mm512_add_pd (zr, zr), zi, dci);
+
+    __m512d d2      = _mm512_fmadd_pd (di, di, _mm512_mul_pd (dr, dr));
+    __mmask8 rebase = _mm512_cmp_pd_mask (z2, d2, _CMP_LT_OS) |
+                      _mm512_cmpeq_epi64_mask (m, len);
+
+    dr = _mm512_mask_blend_pd (rebase, pr, qr);
+    di = _mm512_mask_blend_pd (rebase, pi, qi);
+    m  = _mm512_mask_blend_epi64 (rebase, m1, un);
+    rr = _mm512_mask_blend_pd (rebase, nrr, ref1r);
+    ri = _mm512_mask_blend_pd (rebase, nri, ref1i);
+  }
+
+  iter = _mm512_mask_mov_epi64 (iter, interieur, max_iter);
+
+  _mm256_storeu_si256 ((__m256i *)iterations, _mm512_cvtepi64_epi32 (iter));
+}
+
+#endif
+
+static void traiter_tuile_perturb (int i_d, int j_d, int i_f, int j_f)
+{
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+
+  for (int i = i_d; i <= i_f; i++) {
+    int j = j_d;
+
+#ifdef ENABLE_VECTO
+    unsigned iterations[8];
+
+    if (isa_level >= ISA_AVX512)
+      for (; j + 7 <= j_f; j += 8) {
+        compute_multiple_pixels_perturb_avx512 (iterations, i, j);
+        for (int v = 0; v < 8; v++)
+          cur_iter (i, j + v) = iterations[v];
+      }
+
+    if (isa_level >= ISA_AVX2)
+      for (; j + 3 <= j_f; j += 4) {
+        compute_multiple_pixels_perturb_avx2 (iterations, i, j);
+        for (int v = 0; v < 4; v++)
+          cur_iter (i, j + v) = iterations[v];
+      }
+#endif
+
+    for (; j <= j_f; j++)
+      cur_iter (i, j) = compute_one_pixel_perturb (i, j);
+  }
+}
+
+// Le cadre en float n'est plus utilisé que par les autres variantes
+static void perturb_zoom (void)
+{
+  zoom ();
+  perturb_xstep *= 1 - 2 * ZOOM_SPEED;
+  perturb_ystep *= 1 - 2 * ZOOM_SPEED;
+}
+
+unsigned mandel_compute_perturb (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, perturb_zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+#pragma omp parallel for collapse(2) schedule(runtime)
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++) {
+        traiter_tuile_perturb (i * tranche /* i debut */,
+                               j * tranche /* j debut */,
+                               (i + 1) * tranche - 1 /* i fin */,
+                               (j + 1) * tranche - 1 /* j fin */);
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                             omp_get_thread_num ());
+#endif
+      }
+
+    perturb_zoom ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version Mariani-Silver (ms)
+
+// L'ensemble de Mandelbrot est connexe : si tout le bord d'un rectangle a le
+// même nombre d'itérations, son intérieur aussi. Chaque tuile calcule donc
+// son bord, puis se remplit d'un coup si ce bord est uniforme, ou se découpe
+// en quatre (en calculant la croix qui sépare les quatre sous-rectangles)
+// dans le cas contraire. Les sous-rectangles assez grands deviennent des
+// tâches OpenMP.
+//
+// Avec « --arg exact », l'intérieur des rectangles uniformes est tout de même
+// calculé, et les pixels que le remplissage aurait faussés sont comptés
+// (affichés avec --debug c)
+
+#define MS_MIN_SIZE 8   // en dessous, l'intérieur est calculé directement
+#define MS_TASK_SIZE 32 // au dessus, les sous-rectangles sont des tâches
+
+static bool ms_exact     = false;
+static unsigned ms_wrong = 0;
+
+void mandel_init_ms ()
+{
+  mandel_init ();
+
+  ms_exact = mandel_option ("exact");
+}
+
+#ifdef ENABLE_VECTO
+// Les pixels calculés au-delà du rectangle sont perdus : sur moins de 16
+// pixels, on préfère les vecteurs AVX2 aux vecteurs AVX-512, qui donnent
+// les mêmes valeurs
+static const simd_level_t *ms_simd (int n)
+{
+  if (isa_level == ISA_AVX512 && n < simd->vec_size)
+    return &simd_levels[ISA_AVX2];
+
+  return simd;
+}
+#endif
+
+// Chaque pixel obtient la même valeur qu'avec traiter_tuile_vec : les voies
+// d'un vecteur sont indépendantes, on peut donc calculer un vecteur entier et
+// n'en garder que le début. Les rectangles étroits (les bords verticaux) sont
+// parcourus par colonnes
+static void ms_compute (int i_d, int j_d, int i_f, int j_f)
+{
+#ifdef ENABLE_VECTO
+  unsigned iterations[MAX_VEC_SIZE] __attribute__ ((aligned (64)));
+  const simd_level_t *s = ms_simd (j_f - j_d + 1);
+
+  if (j_f - j_d + 1 < s->vec_size) {
+    s = ms_simd (i_f - i_d + 1);
+
+    for (int j = j_d; j <= j_f; j++)
+      for (int i = i_d; i <= i_f; i += s->vec_size) {
+        s->col (iterations, i, j);
+        for (int v = 0; v < s->vec_size && i + v <= i_f; v++)
+          cur_iter (i + v, j) = iterations[v];
+      }
+  } else
+    for (int i = i_d; i <= i_f; i++)
+      for (int j = j_d; j <= j_f; j += s->vec_size) {
+        s->row (iterations, i, j);
+        if (j + s->vec_size - 1 <= j_f)
+          s->store (&cur_iter (i, j), iterations);
+        else
+          for (int v = 0; j + v <= j_f; v++)
+            cur_iter (i, j + v) = iterations[v];
+      }
+#else
+  traiter_tuile (i_d, j_d, i_f, j_f);
+#endif
+}
+
+static bool ms_uniform_border (int i_d, int j_d, int i_f, int j_f)
+{
+  unsigned c = cur_iter (i_d, j_d);
+
+  for (int j = j_d; j <= j_f; j++)
+    if (cur_iter (i_d, j) != c || cur_iter (i_f, j) != c)
+      return false;
+
+  for (int i = i_d + 1; i < i_f; i++)
+    if (cur_iter (i, j_d) != c || cur_iter (i, j_f) != c)
+      return false;
+
+  return true;
+}
+
+static void ms_fill (int i_d, int j_d, int i_f, int j_f, unsigned c)
+{
+  if (ms_exact) {
+    unsigned wrong = 0;
+
+    ms_compute (i_d, j_d, i_f, j_f);
+
+    for (int i = i_d; i <= i_f; i++)
+      for (int j = j_d; j <= j_f; j++)
+        wrong += (cur_iter (i, j) != c);
+
+#pragma omp atomic
+    ms_wrong += wrong;
+  } else
+    for (int i = i_d; i <= i_f; i++)
+      for (int j = j_d; j <= j_f; j++)
+        cur_iter (i, j) = c;
+}
+
+// Le bord du rectangle [i_d..i_f]x[j_d..j_f] est déjà calculé
+static void ms_subdivide (int i_d, int j_d, int i_f, int j_f)
+{
+  if (i_f - i_d < 2 || j_f - j_d < 2)
+    return;
+
+  if (ms_uniform_border (i_d, j_d, i_f, j_f)) {
+    ms_fill (i_d + 1, j_d + 1, i_f - 1, j_f - 1, cur_iter (i_d, j_d));
+#ifdef ENABLE_MONITORING
+    monitoring_add_tile (j_d, i_d, j_f - j_d + 1, i_f - i_d + 1,
+                         omp_get_thread_num ());
+#endif
+    return;
+  }
+
+  if (i_f - i_d <= MS_MIN_SIZE || j_f - j_d <= MS_MIN_SIZE) {
+    ms_compute (i_d + 1, j_d + 1, i_f - 1, j_f - 1);
+#ifdef ENABLE_MONITORING
+    monitoring_add_tile (j_d, i_d, j_f - j_d + 1, i_f - i_d + 1,
+                         omp_get_thread_num ());
+#endif
+    return;
+  }
+
+  int i_m = (i_d + i_f) / 2;
+  int j_m = (j_d + j_f) / 2;
+
+  ms_compute (i_m, j_d + 1, i_m, j_f - 1);
+  ms_compute (i_d + 1, j_m, i_m - 1, j_m);
+  ms_compute (i_m + 1, j_m, i_f - 1, j_m);
+
+  bool split = (i_f - i_d > MS_TASK_SIZE || j_f - j_d > MS_TASK_SIZE);
+
+#pragma omp task if (split)
+  ms_subdivide (i_d, j_d, i_m, j_m);
+#pragma omp task if (split)
+  ms_subdivide (i_d, j_m, i_m, j_f);
+#pragma omp task if (split)
+  ms_subdivide (i_m, j_d, i_f, j_m);
+#pragma omp task if (split)
+  ms_subdivide (i_m, j_m, i_f, j_f);
+}
+
+static void ms_tile (int i_d, int j_d, int i_f, int j_f)
+{
+  ms_compute (i_d, j_d, i_d, j_f);
+  ms_compute (i_f, j_d, i_f, j_f);
+  ms_compute (i_d + 1, j_d, i_f - 1, j_d);
+  ms_compute (i_d + 1, j_f, i_f - 1, j_f);
+
+  ms_subdivide (i_d, j_d, i_f, j_f);
+}
+
+unsigned mandel_compute_ms (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    ms_wrong = 0;
+
+#pragma omp parallel
+#pragma omp single
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++)
+#pragma omp task firstprivate(i, j)
+        ms_tile (i * tranche /* i debut */, j * tranche /* j debut */,
+                 (i + 1) * tranche - 1 /* i fin */,
+                 (j + 1) * tranche - 1 /* j fin */);
+
+    if (ms_exact)
+      PRINT_DEBUG ('c', "Mariani-Silver would have filled %u wrong pixels\n",
+                   ms_wrong);
+
+    zoom ();
+  }
+
+  return 0;
+}
+
 //////////////////////////////////////////////////////////////////////////
 ///////////////////////////// Version OpenCL
 
 void mandel_init_ocl ()
 {
-  xstep = (rightX - leftX) / DIM;
-  ystep = (topY - bottomY) / DIM;
+  mandel_init ();
 }
 
+// L'image est calculée directement par le GPU : le tampon des itérations
+// n'est pas utilisé
+void mandel_refresh_img_ocl (void)
+{
+}
+
+// La palette est envoyée une fois au GPU, au premier appel (le contexte
+// OpenCL n'existe pas encore lors de mandel_init_ocl)
+static cl_mem lut_buffer = NULL;
+
 unsigned mandel_compute_ocl (unsigned nb_iter)
 {
   size_t global[2] = {SIZE, SIZE};   // global domain size for our calculation
@@ -673,17 +2825,27 @@ unsigned mandel_compute_ocl (unsigned nb_iter)
   cl_int err;
   unsigned max_iter = MAX_ITERATIONS;
 
+  if (lut_buffer == NULL) {
+    lut_buffer =
+        clCreateBuffer (context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                        sizeof (color_lut), color_lut, &err);
+    check (err, "Failed to allocate palette buffer");
+  }
+
+  nb_iter -= skip_unseen_frames (nb_iter, zoom);
+
   for (unsigned it = 1; it <= nb_iter; it++) {
 
     // Set kernel arguments
     //
     err = 0;
     err |= clSetKernelArg (compute_kernel, 0, sizeof (cl_mem), &cur_buffer);
-    err |= clSetKernelArg (compute_kernel, 1, sizeof (float), &leftX);
-    err |= clSetKernelArg (compute_kernel, 2, sizeof (float), &xstep);
-    err |= clSetKernelArg (compute_kernel, 3, sizeof (float), &topY);
-    err |= clSetKernelArg (compute_kernel, 4, sizeof (float), &ystep);
+    err |= clSetKernelArg (compute_kernel, 1, sizeof (float), &anim.leftX);
+    err |= clSetKernelArg (compute_kernel, 2, sizeof (float), &anim.xstep);
+    err |= clSetKernelArg (compute_kernel, 3, sizeof (float), &anim.topY);
+    err |= clSetKernelArg (compute_kernel, 4, sizeof (float), &anim.ystep);
     err |= clSetKernelArg (compute_kernel, 5, sizeof (unsigned), &max_iter);
+    err |= clSetKernelArg (compute_kernel, 6, sizeof (cl_mem), &lut_buffer);
 
     check (err, "Failed to set kernel arguments");
 
@@ -1,7 +1,8 @@
-
 #define _GNU_SOURCE
 #include <hwloc.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,16 +10,26 @@
 #include "debug.h"
 #include "scheduler.h"
 
+// Each worker owns a Chase-Lev work-stealing deque: the owner pushes and
+// pops at the bottom without any lock, idle workers steal from the top of a
+// randomly chosen victim. Tasks submitted from outside the workers (e.g. by
+// the main thread) go into a shared inject queue, and tasks bound to a given
+// cpu go into that worker's mailbox, which no other worker drains.
+//
+// See Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing
+// for Weak Memory Models" (PPoPP'13) for the memory orderings used below.
+
 static int nbWorkers;
 
-volatile static int nbTask = 0;
-pthread_mutex_t mutex      = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t cond        = PTHREAD_COND_INITIALIZER;
+static atomic_int nbTask = 0; // tasks submitted but not completed yet
+pthread_mutex_t mutex    = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t cond      = PTHREAD_COND_INITIALIZER;
 
 static hwloc_topology_t topology;
 static unsigned nb_cores, numa_nodes;
 
-#define WORK_QUEUE 1024
+#define WORK_QUEUE 1024 // initial capacity of a deque (power of 2)
+#define IDLE_SPINS 64   // failed steal rounds before going to sleep
 
 struct task
 {
@@ -26,60 +37,275 @@ struct task
   void *p;
 };
 
+// Slots are read by thieves while the owner may be writing them: a thief
+// that reads a half-written slot always fails its CAS on top afterwards
+struct slot
+{
+  _Atomic (task_func_t) fun;
+  _Atomic (void *) p;
+};
+
+struct array
+{
+  long size;
+  struct array *prev; // retired arrays, freed by scheduler_finalize
+  struct slot slots[];
+};
+
+struct deque
+{
+  atomic_long top;
+  char padding[64 - sizeof (atomic_long)]; // no false sharing with bottom
+  atomic_long bottom;
+  _Atomic (struct array *) array;
+  pthread_mutex_t push_lock; // serializes producers of shared queues only
+};
+
+enum
+{
+  OWNER_LIFO,
+  OWNER_FIFO
+};
+
+static int owner_policy = OWNER_LIFO;
+
 struct worker
 {
   int id;
   pthread_t tid;
   pthread_attr_t attr;
-  pthread_cond_t cond;
-  pthread_mutex_t mutex;
-  int fin, todo;
-  struct task tasks[WORK_QUEUE];
-  unsigned d, f;
+  struct deque deque;   // tasks created by this worker
+  struct deque mailbox; // tasks bound to this worker
+  atomic_int pending;   // tasks in the mailbox, not taken yet
+  atomic_int asleep;    // waiting on wake, not signalled yet (idle_mutex)
+  pthread_cond_t wake;
+  unsigned seed; // victim selection
+  unsigned tasks, steals;
 } * workers;
 
+static struct deque inject;
+
+// Idle workers sleep until some task they may run is queued: stealable
+// tasks (inject queue and deques) are counted in queued and wake up any
+// sleeper, mailbox tasks are counted per worker and wake up their owner only
+static atomic_int queued          = 0; // stealable tasks pushed, not taken yet
+static atomic_int sleepers        = 0; // workers with asleep set
+static atomic_int fin             = 0;
+static pthread_mutex_t idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread struct worker *self = NULL;
+
+static struct array *array_new (long size, struct array *prev)
+{
+  struct array *a =
+      malloc (sizeof (struct array) + size * sizeof (struct slot));
+
+  a->size = size;
+  a->prev = prev;
+
+  return a;
+}
+
+static void deque_init (struct deque *q)
+{
+  atomic_init (&q->top, 0);
+  atomic_init (&q->bottom, 0);
+  atomic_init (&q->array, array_new (WORK_QUEUE, NULL));
+  pthread_mutex_init (&q->push_lock, NULL);
+}
+
+static void deque_destroy (struct deque *q)
+{
+  struct array *a = atomic_load_explicit (&q->array, memory_order_relaxed);
+
+  while (a != NULL) {
+    struct array *prev = a->prev;
+    free (a);
+    a = prev;
+  }
+  pthread_mutex_destroy (&q->push_lock);
+}
+
+// Doubles the capacity. The old array stays readable by pending thieves
+static struct array *deque_grow (struct deque *q, struct array *a, long t,
+                                 long b)
+{
+  struct array *n = array_new (2 * a->size, a);
+
+  for (long i = t; i < b; i++) {
+    struct slot *src = &a->slots[i & (a->size - 1)];
+    struct slot *dst = &n->slots[i & (n->size - 1)];
+
+    atomic_store_explicit (
+        &dst->fun, atomic_load_explicit (&src->fun, memory_order_relaxed),
+        memory_order_relaxed);
+    atomic_store_explicit (&dst->p,
+                           atomic_load_explicit (&src->p, memory_order_relaxed),
+                           memory_order_relaxed);
+  }
+  atomic_store_explicit (&q->array, n, memory_order_release);
+
+  PRINT_DEBUG ('s', "Deque grown to %ld tasks\n", n->size);
+
+  return n;
+}
+
+// Owner only (or any producer holding push_lock)
+static void deque_push (struct deque *q, struct task todo)
+{
+  long b          = atomic_load_explicit (&q->bottom, memory_order_relaxed);
+  long t          = atomic_load_explicit (&q->top, memory_order_acquire);
+  struct array *a = atomic_load_explicit (&q->array, memory_order_relaxed);
+
+  if (b - t > a->size - 1)
+    a = deque_grow (q, a, t, b);
+
+  struct slot *s = &a->slots[b & (a->size - 1)];
+  atomic_store_explicit (&s->fun, todo.fun, memory_order_relaxed);
+  atomic_store_explicit (&s->p, todo.p, memory_order_relaxed);
+  atomic_thread_fence (memory_order_release);
+  atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+}
+
+// Owner only: takes the most recently pushed task
+static int deque_take (struct deque *q, struct task *todo)
+{
+  long b = atomic_load_explicit (&q->bottom, memory_order_relaxed) - 1;
+  struct array *a = atomic_load_explicit (&q->array, memory_order_relaxed);
+  int found       = 1;
+
+  atomic_store_explicit (&q->bottom, b, memory_order_relaxed);
+  atomic_thread_fence (memory_order_seq_cst);
+  long t = atomic_load_explicit (&q->top, memory_order_relaxed);
+
+  if (t <= b) {
+    struct slot *s = &a->slots[b & (a->size - 1)];
+    todo->fun      = atomic_load_explicit (&s->fun, memory_order_relaxed);
+    todo->p        = atomic_load_explicit (&s->p, memory_order_relaxed);
+
+    if (t == b) {
+      // Last task: race against thieves
+      if (!atomic_compare_exchange_strong_explicit (&q->top, &t, t + 1,
+                                                    memory_order_seq_cst,
+                                                    memory_order_relaxed))
+        found = 0;
+      atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+    }
+  } else {
+    found = 0;
+    atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+  }
+
+  return found;
+}
+
+// Any thread: takes the oldest task. Fails if the deque is empty or if
+// another thread took the same task first
+static int deque_steal (struct deque *q, struct task *todo)
+{
+  long t = atomic_load_explicit (&q->top, memory_order_acquire);
+  atomic_thread_fence (memory_order_seq_cst);
+  long b = atomic_load_explicit (&q->bottom, memory_order_acquire);
+
+  if (t >= b)
+    return 0;
+
+  struct array *a = atomic_load_explicit (&q->array, memory_order_acquire);
+  struct slot *s  = &a->slots[t & (a->size - 1)];
+
+  todo->fun = atomic_load_explicit (&s->fun, memory_order_relaxed);
+  todo->p   = atomic_load_explicit (&s->p, memory_order_relaxed);
+
+  return atomic_compare_exchange_strong_explicit (
+      &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Shared queues have several producers (the threads calling
+// scheduler_create_task from outside the workers) and are drained by
+// stealing only
+static void shared_push (struct deque *q, struct task todo)
+{
+  pthread_mutex_lock (&q->push_lock);
+  deque_push (q, todo);
+  pthread_mutex_unlock (&q->push_lock);
+}
+
 void scheduler_task_wait ()
 {
   pthread_mutex_lock (&mutex);
-  while (nbTask > 0)
+  while (atomic_load (&nbTask) > 0)
     pthread_cond_wait (&cond, &mutex);
   pthread_mutex_unlock (&mutex);
 }
 
-static void one_more_task ()
+static void one_less_task ()
 {
-  pthread_mutex_lock (&mutex);
-  nbTask++;
-  pthread_mutex_unlock (&mutex);
+  if (atomic_fetch_sub (&nbTask, 1) == 1) {
+    pthread_mutex_lock (&mutex);
+    pthread_cond_broadcast (&cond);
+    pthread_mutex_unlock (&mutex);
+  }
 }
 
-static void one_less_task ()
+// The counters and the sleep flags are all seq_cst: either the producer
+// sees a sleeper and wakes it up, or the worker about to sleep sees the new
+// task. A signalled worker loses its asleep flag at once, so that a burst of
+// pushes wakes up a different sleeper each time. Called with idle_mutex held
+static void signal_worker (struct worker *w)
 {
-  pthread_mutex_lock (&mutex);
-  nbTask--;
-  if (nbTask == 0)
-    pthread_cond_signal (&cond);
-  pthread_mutex_unlock (&mutex);
+  if (atomic_load (&w->asleep)) {
+    atomic_store (&w->asleep, 0);
+    atomic_fetch_sub (&sleepers, 1);
+    pthread_cond_signal (&w->wake);
+  }
 }
 
-static void add_task (struct task todo, int w)
+static void wake_up_idle (void)
 {
-  one_more_task ();
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].tasks[workers[w].f] = todo;
-  workers[w].f                   = (workers[w].f + 1) % WORK_QUEUE;
-  workers[w].todo++;
-  assert (workers[w].todo < WORK_QUEUE);
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  atomic_fetch_add (&queued, 1);
+
+  if (atomic_load (&sleepers) > 0) {
+    pthread_mutex_lock (&idle_mutex);
+    for (int i = 0; i < nbWorkers; i++)
+      if (atomic_load (&workers[i].asleep)) {
+        signal_worker (&workers[i]);
+        break;
+      }
+    pthread_mutex_unlock (&idle_mutex);
+  }
 }
 
-static void no_more_task (int w)
+static void wake_up_owner (struct worker *w)
 {
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].fin = 1;
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  atomic_fetch_add (&w->pending, 1);
+
+  if (atomic_load (&w->asleep)) {
+    pthread_mutex_lock (&idle_mutex);
+    signal_worker (w);
+    pthread_mutex_unlock (&idle_mutex);
+  }
+}
+
+// The flag is raised again before every check, since the task a worker was
+// signalled for may have been taken by someone else in the meantime
+static void sleep_while_idle (struct worker *me)
+{
+  pthread_mutex_lock (&idle_mutex);
+  for (;;) {
+    if (!atomic_load (&me->asleep)) {
+      atomic_store (&me->asleep, 1);
+      atomic_fetch_add (&sleepers, 1);
+    }
+    if (atomic_load (&queued) > 0 || atomic_load (&me->pending) > 0 ||
+        atomic_load (&fin))
+      break;
+    pthread_cond_wait (&me->wake, &idle_mutex);
+  }
+  if (atomic_load (&me->asleep)) {
+    atomic_store (&me->asleep, 0);
+    atomic_fetch_sub (&sleepers, 1);
+  }
+  pthread_mutex_unlock (&idle_mutex);
 }
 
 void scheduler_create_task (task_func_t task, void *param, unsigned cpu)
@@ -89,22 +315,64 @@ void scheduler_create_task (task_func_t task, void *param, unsigned cpu)
   todo.p   = param;
   todo.fun = task;
 
-  if (cpu == -1) {
-    static int cyclic = 0;
-    // We quickly go through the list of workers to find an idle one, or the
-    // least busy one
-    PRINT_DEBUG ('s', "Dynamic task scheduling is not yet implemented\n");
-    cpu    = cyclic;
-    cyclic = (cyclic + 1) % nbWorkers;
+  atomic_fetch_add (&nbTask, 1);
+
+  if (cpu != -1) {
+    struct worker *w = &workers[cpu % nbWorkers];
+
+    shared_push (&w->mailbox, todo);
+    wake_up_owner (w);
+    return;
+  }
+
+  if (self != NULL)
+    deque_push (&self->deque, todo);
+  else
+    shared_push (&inject, todo);
+
+  wake_up_idle ();
+}
+
+static int steal_from_victim (struct worker *me, struct task *todo)
+{
+  for (int n = 1; n < nbWorkers; n++) {
+    int v = rand_r (&me->seed) % nbWorkers;
+
+    if (v != me->id && deque_steal (&workers[v].deque, todo)) {
+      me->steals++;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+// Each task taken is discounted from the counter it was accounted in
+static int find_task (struct worker *me, struct task *todo)
+{
+  if (owner_policy == OWNER_LIFO ? deque_take (&me->deque, todo)
+                                 : deque_steal (&me->deque, todo)) {
+    atomic_fetch_sub (&queued, 1);
+    return 1;
+  }
+
+  if (deque_steal (&me->mailbox, todo)) {
+    atomic_fetch_sub (&me->pending, 1);
+    return 1;
+  }
+
+  if (deque_steal (&inject, todo) || steal_from_victim (me, todo)) {
+    atomic_fetch_sub (&queued, 1);
+    return 1;
   }
-  add_task (todo, cpu);
+
+  return 0;
 }
 
 static void *worker_main (void *p)
 {
   struct worker *me = (struct worker *)p;
   struct task todo  = {NULL, NULL};
-  unsigned tasks    = 0;
   hwloc_obj_t obj;
   hwloc_bitmap_t set;
 
@@ -113,34 +381,30 @@ static void *worker_main (void *p)
   // hwloc_bitmap_singlify (set);
   hwloc_set_cpubind (topology, set, HWLOC_CPUBIND_THREAD);
 
-  PRINT_DEBUG ('s', "Hey, I'm worker %d\n", me->id);
+  self = me;
 
-  while (1) {
+  PRINT_DEBUG ('s', "Hey, I'm worker %d\n", me->id);
 
-    pthread_mutex_lock (&me->mutex);
+  for (int idle = 0; !atomic_load_explicit (&fin, memory_order_relaxed);) {
 
-    if (me->d == me->f && me->fin == 0)
-      pthread_cond_wait (&me->cond, &me->mutex);
+    if (find_task (me, &todo)) {
+      idle = 0;
 
-    if (me->d != me->f) {
-      todo  = me->tasks[me->d];
-      me->d = (me->d + 1) % WORK_QUEUE;
-      me->todo--;
-    } else if (me->fin == 1) {
-      me->fin = -1;
+      me->tasks++;
+      todo.fun (todo.p, me->id);
+      one_less_task ();
+    } else if (++idle < IDLE_SPINS)
+      sched_yield ();
+    else {
+      sleep_while_idle (me);
+      idle = 0;
     }
+  }
 
-    pthread_mutex_unlock (&me->mutex);
-
-    if (me->fin == -1) {
-      PRINT_DEBUG ('s', "Worker %d has computed %d tasks\n", me->id, tasks);
-      return NULL;
-    }
+  PRINT_DEBUG ('s', "Worker %d has computed %d tasks (%d stolen)\n", me->id,
+               me->tasks, me->steals);
 
-    tasks++;
-    todo.fun (todo.p, me->id);
-    one_less_task ();
-  }
+  return NULL;
 }
 
 unsigned scheduler_init (unsigned default_P)
@@ -170,20 +434,37 @@ unsigned scheduler_init (unsigned default_P)
   } else
     nbWorkers = atoi (str);
 
-  PRINT_DEBUG ('s', "[Starting %d workers]\n", nbWorkers);
+  // Order in which a worker runs its own tasks (thieves always take the
+  // oldest ones)
+  str = getenv ("SCHEDULER_POLICY");
+  if (str != NULL && !strcmp (str, "fifo"))
+    owner_policy = OWNER_FIFO;
+  else
+    owner_policy = OWNER_LIFO;
+
+  PRINT_DEBUG ('s', "[Starting %d workers, %s]\n", nbWorkers,
+               owner_policy == OWNER_LIFO ? "LIFO" : "FIFO");
+
+  atomic_store (&fin, 0);
+  deque_init (&inject);
 
   workers = malloc (nbWorkers * sizeof (struct worker));
 
   for (i = 0; i < nbWorkers; i++) {
-    workers[i].id   = i;
-    workers[i].fin  = 0;
-    workers[i].todo = 0;
-    workers[i].d    = 0;
-    workers[i].f    = 0;
-    pthread_cond_init (&workers[i].cond, NULL);
-    pthread_mutex_init (&workers[i].mutex, NULL);
-    pthread_attr_init (&workers[i].attr);
+    workers[i].id     = i;
+    workers[i].seed   = i + 1;
+    workers[i].tasks  = 0;
+    workers[i].steals = 0;
+    deque_init (&workers[i].deque);
+    deque_init (&workers[i].mailbox);
+    atomic_init (&workers[i].pending, 0);
+    atomic_init (&workers[i].asleep, 0);
+    pthread_cond_init (&workers[i].wake, NULL);
+  }
 
+  // Workers may steal from each other as soon as they start
+  for (i = 0; i < nbWorkers; i++) {
+    pthread_attr_init (&workers[i].attr);
     pthread_create (&workers[i].tid, &workers[i].attr, worker_main,
                     &workers[i]);
   }
@@ -195,12 +476,22 @@ void scheduler_finalize (void)
 {
   int i;
 
+  pthread_mutex_lock (&idle_mutex);
+  atomic_store (&fin, 1);
   for (i = 0; i < nbWorkers; i++)
-    no_more_task (i);
+    pthread_cond_signal (&workers[i].wake);
+  pthread_mutex_unlock (&idle_mutex);
 
   for (i = 0; i < nbWorkers; i++)
     pthread_join (workers[i].tid, NULL);
 
+  for (i = 0; i < nbWorkers; i++) {
+    deque_destroy (&workers[i].deque);
+    deque_destroy (&workers[i].mailbox);
+    pthread_cond_destroy (&workers[i].wake);
+  }
+  deque_destroy (&inject);
+
   free (workers);
 
   /* Destroy topology object. */
@@ -1,49 +1,177 @@
 
 #include "compute.h"
+#include "constants.h"
 #include "debug.h"
+#include "error.h"
 #include "global.h"
 #include "graphics.h"
+#include "monitoring.h"
 #include "ocl.h"
 #include "scheduler.h"
 
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 
+#ifdef ENABLE_VECTO
+#include <immintrin.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-static int compute_new_state (int y, int x)
+#ifdef P2P_TEST
+#include <unistd.h>
+#endif
+
+static unsigned couleur = 0xFFFF00FF; // Yellow
+
+// Les paramètres passés via --arg sont séparés par des virgules : ceux de la
+// forme clé=valeur règlent les variantes (ex. « --arg random,depth=4 »), le
+// premier des autres désigne la fonction de dessin (voir vie_draw)
+static int vie_option (const char *key, int default_value)
 {
-  unsigned n      = 0;
-  unsigned change = 0;
+  size_t len = strlen (key);
 
-  if (x > 0 && x < DIM - 1 && y > 0 && y < DIM - 1) {
-    for (int i = y - 1; i <= y + 1; i++)
-      for (int j = x - 1; j <= x + 1; j++)
-        if (i != y || j != x)
-          n += (cur_img (i, j) != 0);
+  for (char *p = draw_param; p != NULL;) {
+    if (!strncmp (p, key, len) && p[len] == '=')
+      return atoi (p + len + 1);
 
-    if (cur_img (y, x) != 0) {
-      if (n == 2 || n == 3)
-        n = 0xFFFF00FF;
-      else {
-        n      = 0;
-        change = 1;
-      }
-    } else {
-      if (n == 3) {
-        n      = 0xFFFF00FF;
-        change = 1;
-      } else
-        n = 0;
+    p = strchr (p, ',');
+    if (p != NULL)
+      p++;
+  }
+
+  return default_value;
+}
+
+// L'état de l'automate est une grille d'octets (0 ou 1) propre au noyau,
+// quatre fois plus compacte que l'image : celle-ci n'est reconstruite que
+// lorsqu'une image doit être affichée ou sauvegardée (vie_refresh_img)
+
+static uint8_t *restrict cur_cells = NULL, *restrict next_cells = NULL;
+
+#define cur_cell(y, x) (cur_cells[(y) * DIM + (x)])
+#define next_cell(y, x) (next_cells[(y) * DIM + (x)])
+
+// Détection des cycles : l'état de l'automate est résumé par un hachage de
+// 64 bits, le XOR des hachages de ses cellules vivantes. Ce hachage se met à
+// jour de façon incrémentale (chaque tuile accumule les hachages des cellules
+// qui ont changé) et les derniers hachages sont conservés dans un anneau :
+// retrouver l'un d'eux signifie que l'automate oscille avec une période
+// inférieure à la taille de l'anneau, qui se règle avec « --arg cycles=N »
+// (0, la valeur par défaut, désactive la détection)
+
+static uint64_t *history = NULL; // anneau des derniers hachages
+static unsigned history_size = 0, history_pos = 0, history_len = 0;
+static uint64_t state_hash = 0;
+
+// Adresse où accumuler les changements d'une génération, NULL si la
+// détection est désactivée (on évite alors de hacher les cellules)
+#define cycle_delta(d) (history_size ? &(d) : NULL)
+
+static inline uint64_t cell_hash (int y, int x)
+{
+  uint64_t h = (uint64_t)y * DIM + x + 0x9E3779B97F4A7C15ULL;
+
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+
+  return h ^ (h >> 31);
+}
+
+static void history_push (uint64_t h)
+{
+  history[history_pos] = h;
+  history_pos          = (history_pos + 1) % history_size;
+  history_len          = MIN (history_len + 1, history_size);
+}
+
+static void cycles_init (void)
+{
+  history_size = vie_option ("cycles", 0);
+  if (history_size == 0)
+    return;
+
+  history     = malloc (history_size * sizeof (uint64_t));
+  history_pos = history_len = 0;
+  state_hash  = 0;
+
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      if (cur_cell (y, x))
+        state_hash ^= cell_hash (y, x);
+
+  history_push (state_hash);
+}
+
+// Met à jour le hachage de l'état avec les changements d'une génération et
+// renvoie vrai si cet état a été rencontré lors des dernières générations
+static int cycle_detected (uint64_t delta)
+{
+  if (history_size == 0)
+    return 0;
+
+  state_hash ^= delta;
+
+  for (unsigned p = 1; p <= history_len; p++)
+    if (history[(history_pos + history_size - p) % history_size] ==
+        state_hash) {
+      PRINT_DEBUG ('c', "Cycle of period %u detected\n", p);
+      return 1;
     }
 
-    next_img (y, x) = n;
-  }
+  history_push (state_hash);
 
-  return change;
+  return 0;
+}
+
+static void cells_import (void)
+{
+  cur_cells  = malloc (DIM * DIM * sizeof (uint8_t));
+  next_cells = malloc (DIM * DIM * sizeof (uint8_t));
+
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      cur_cell (y, x) = (cur_img (y, x) != 0);
+
+  // Les cellules de bordure ne changent jamais
+  memcpy (next_cells, cur_cells, DIM * DIM * sizeof (uint8_t));
+
+  cycles_init ();
+}
+
+static inline void swap_cells (void)
+{
+  uint8_t *tmp = cur_cells;
+
+  cur_cells  = next_cells;
+  next_cells = tmp;
+}
+
+void vie_refresh_img (void)
+{
+  if (cur_cells == NULL)
+    return;
+
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      cur_img (y, x) = cur_cell (y, x) ? couleur : 0;
+}
+
+void vie_finalize (void)
+{
+  free (cur_cells);
+  free (next_cells);
+  free (history);
+  cur_cells = next_cells = NULL;
+  history   = NULL;
 }
 
-static int compute_new_state_opt (int y, int x)
+static int compute_new_state (int y, int x)
 {
   unsigned n      = 0;
   unsigned change = 0;
@@ -52,65 +180,67 @@ static int compute_new_state_opt (int y, int x)
     for (int i = y - 1; i <= y + 1; i++)
       for (int j = x - 1; j <= x + 1; j++)
         if (i != y || j != x)
-          n += (cur_bit (i, j) != 0);
+          n += cur_cell (i, j);
 
-    if (cur_img (y, x) != 0) {
+    if (cur_cell (y, x)) {
       if (n == 2 || n == 3)
-        n = 0xFFFF00FF;
+        n = 1;
       else {
         n      = 0;
         change = 1;
       }
     } else {
       if (n == 3) {
-        n      = 0xFFFF00FF;
+        n      = 1;
         change = 1;
       } else
         n = 0;
     }
 
-    next_img (y, x) = n;
+    next_cell (y, x) = n;
   }
 
   return change;
 }
 
-static int traiter_tuile (int i_d, int j_d, int i_f, int j_f)
+// Si hash n'est pas NULL, on y accumule (par XOR) les hachages des cellules
+// qui ont changé
+static int traiter_tuile (int i_d, int j_d, int i_f, int j_f, uint64_t *hash)
 {
   unsigned change = 0;
+  uint64_t delta  = 0;
 
   PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
 
   for (int i = i_d; i <= i_f; i++)
-    for (int j = j_d; j <= j_f; j++){
-      change |= compute_new_state (i, j);
-    }
-  return change;
-}
-
-static int traiter_tuile_opt (int i_d, int j_d, int i_f, int j_f)
-{
-  //printf("traiter_tuile_opt DEBUG\n");
-  unsigned change = 0;
+    for (int j = j_d; j <= j_f; j++)
+      if (compute_new_state (i, j)) {
+        change = 1;
+        if (hash != NULL)
+          delta ^= cell_hash (i, j);
+      }
 
-  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+  if (hash != NULL)
+    *hash ^= delta;
 
-  for (int i = i_d; i <= i_f; i++)
-    for (int j = j_d; j <= j_f; j++){
-      change |= compute_new_state_opt (i, j);
-    }
   return change;
 }
 
 // Renvoie le nombre d'itérations effectuées avant stabilisation, ou 0
 unsigned vie_compute_seq (unsigned nb_iter)
 {
+  if (cur_cells == NULL)
+    cells_import ();
+
   for (unsigned it = 1; it <= nb_iter; it++) {
+    uint64_t delta = 0;
+
     // On traite toute l'image en un coup (oui, c'est une grosse tuile)
-    unsigned change = traiter_tuile (0, 0, DIM - 1, DIM - 1);
-    swap_images ();
+    unsigned change =
+        traiter_tuile (0, 0, DIM - 1, DIM - 1, cycle_delta (delta));
+    swap_cells ();
 
-    if (!change){
+    if (!change || cycle_detected (delta)) {
       return it;
     }
   }
@@ -122,6 +252,9 @@ unsigned vie_compute_seq (unsigned nb_iter)
 
 unsigned vie_compute_tiled (unsigned nb_iter)
 {
+  if (cur_cells == NULL)
+    cells_import ();
+
   static unsigned tranche = 0;
   tranche = DIM / GRAIN;
 
@@ -132,75 +265,1986 @@ unsigned vie_compute_tiled (unsigned nb_iter)
       for (int j = 0; j < GRAIN; j++)
         traiter_tuile (i * tranche /* i debut */, j * tranche /* j debut */,
                            (i + 1) * tranche - 1 /* i fin */,
-                           (j + 1) * tranche - 1 /* j fin */);
+                           (j + 1) * tranche - 1 /* j fin */, NULL);
   
-    swap_images ();
+    swap_cells ();
   }
   return 0;
 }
 
-///////////////////////////// Version optimisée
+///////////////////////////// Version OpenMP avec omp for (omp)
 
-unsigned vie_compute_opt (unsigned nb_iter)
+// Les indicateurs de changement des tuiles sont combinés par une réduction :
+// chaque thread accumule dans une copie privée, sans faux partage
+unsigned vie_compute_omp (unsigned nb_iter)
 {
-  printf("opt DEBUG\n");
-  img_bit_array = (uint8_t *) malloc(DIM*DIM * sizeof(uint8_t));
-
-  printf("img_to_bytes DEBUG\n");
-  for(int x=0; x<DIM; x++)
-    for(int y=0; y<DIM; y++)
-      if (x > 0 && x < DIM - 1 && y > 0 && y < DIM - 1)
-        for (int i=0; i<8; i++){
-         // printf("for (%d,%d) (img_to_bytes) DEBUG\n",x,y);
-          img_bit_array[(DIM*y+x)+i/8] |= ((cur_img (x, y) != 0) << (i%8)); //set the nth bit to 1 if it's a living neighbour
-          }
+  if (cur_cells == NULL)
+    cells_import ();
 
-  static unsigned tranche = 0;
-  tranche = DIM / GRAIN;
+  unsigned tranche = DIM / GRAIN;
 
   for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned change = 0;
+    uint64_t delta  = 0;
 
     // On itére sur les coordonnées des tuiles
+#pragma omp parallel for collapse(2) schedule(runtime)                         \
+    reduction(| : change) reduction(^ : delta)
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++) {
+        change |= traiter_tuile (i * tranche /* i debut */,
+                                 j * tranche /* j debut */,
+                                 (i + 1) * tranche - 1 /* i fin */,
+                                 (j + 1) * tranche - 1 /* j fin */,
+                                 cycle_delta (delta));
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                             omp_get_thread_num ());
+#endif
+      }
+
+    swap_cells ();
+
+    if (!change || cycle_detected (delta))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version OpenMP avec tâches (omp_task)
+
+unsigned vie_compute_omp_task (unsigned nb_iter)
+{
+  if (cur_cells == NULL)
+    cells_import ();
+
+  unsigned tranche = DIM / GRAIN;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned change = 0;
+    uint64_t delta  = 0;
+
+#pragma omp parallel
+#pragma omp single
+#pragma omp taskgroup task_reduction(| : change) task_reduction(^ : delta)
     for (int i = 0; i < GRAIN; i++)
       for (int j = 0; j < GRAIN; j++)
-        traiter_tuile_opt (i * tranche /* i debut */, j * tranche /* j debut */,
-                           (i + 1) * tranche - 1 /* i fin */,
-                           (j + 1) * tranche - 1 /* j fin */);
-  
-    swap_images ();
+#pragma omp task firstprivate(i, j) in_reduction(| : change)                 \
+    in_reduction(^ : delta)
+      {
+        change |= traiter_tuile (i * tranche /* i debut */,
+                                 j * tranche /* j debut */,
+                                 (i + 1) * tranche - 1 /* i fin */,
+                                 (j + 1) * tranche - 1 /* j fin */,
+                                 cycle_delta (delta));
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                             omp_get_thread_num ());
+#endif
+      }
+
+    swap_cells ();
+
+    if (!change || cycle_detected (delta))
+      return it;
   }
+
   return 0;
 }
 
-///////////////////////////// Configuration initiale
+///////////////////////////// Version avec blocage temporel (temporal)
 
-void draw_stable (void);
-void draw_guns (void);
-void draw_random (void);
-void draw_clown (void);
-void draw_diehard (void);
+// Chaque tuile est chargée avec une bordure fantôme de largeur k dans un
+// tampon d'octets privé au thread, puis avance de k générations sans
+// retourner en mémoire : la zone valide rétrécit d'une cellule par génération
+// et, au bout de k générations, seul l'intérieur de la tuile est recopié dans
+// next_cells. La profondeur k se règle avec « --arg depth=k ».
 
-void vie_draw (char *param)
+#define DEFAULT_DEPTH 4
+#define MAX_DEPTH 32
+
+static unsigned depth = DEFAULT_DEPTH;
+
+void vie_init_temporal (void)
 {
-  char func_name[1024];
-  void (*f) (void) = NULL;
+  depth = vie_option ("depth", DEFAULT_DEPTH);
+  depth = MAX (1, MIN (depth, MAX_DEPTH));
 
-  if (param == NULL)
-    f = draw_guns;
-  else {
-    sprintf (func_name, "draw_%s", param);
-    f = dlsym (DLSYM_FLAG, func_name);
+  PRINT_DEBUG ('c', "Temporal blocking depth: %u\n", depth);
+}
 
-    if (f == NULL) {
-      PRINT_DEBUG ('g', "Cannot resolve draw function: %s\n", func_name);
-      f = draw_guns;
+// Avance la tuile [i_d..i_d+tranche-1][j_d..j_d+tranche-1] de k générations.
+// Le bit t du résultat indique si une cellule de la tuile a changé lors de la
+// (t+1)-ième génération
+static unsigned traiter_tuile_temporal (int i_d, int j_d, unsigned tranche,
+                                        unsigned k, uint8_t *restrict cur,
+                                        uint8_t *restrict next)
+{
+  const int size = tranche + 2 * k;
+  const int y0 = i_d - k, x0 = j_d - k; // origine du tampon dans l'image
+  unsigned change = 0;
+
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée (%u générations)\n", i_d,
+               i_d + tranche - 1, j_d, j_d + tranche - 1, k);
+
+#define buf_cell(b, y, x) ((b)[(y)*size + (x)])
+
+  // Chargement de la tuile et de sa bordure fantôme dans les deux tampons
+  // (les cellules hors de l'image sont mortes)
+  for (int y = 0; y < size; y++)
+    for (int x = 0; x < size; x++) {
+      int gy = y0 + y, gx = x0 + x;
+      uint8_t v = 0;
+
+      if (gy >= 0 && gy < DIM && gx >= 0 && gx < DIM)
+        v = cur_cell (gy, gx);
+
+      buf_cell (cur, y, x) = buf_cell (next, y, x) = v;
     }
+
+  // Les cellules de bordure de l'image ne sont jamais recalculées, pas plus
+  // que celles au-delà de GRAIN * tranche lorsque DIM n'est pas un multiple de
+  // GRAIN : elles restent figées comme dans les autres variantes par tuiles
+  const int last  = MIN (DIM - 2, GRAIN * (int)tranche - 1);
+  const int y_min = MAX (1 - y0, 1), y_max = MIN (last - y0, size - 2);
+  const int x_min = MAX (1 - x0, 1), x_max = MIN (last - x0, size - 2);
+
+  for (unsigned t = 1; t <= k; t++) {
+    for (int y = MAX (y_min, (int)t); y <= MIN (y_max, size - 1 - (int)t); y++)
+      for (int x = MAX (x_min, (int)t); x <= MIN (x_max, size - 1 - (int)t);
+           x++) {
+        uint8_t n = buf_cell (cur, y - 1, x - 1) + buf_cell (cur, y - 1, x) +
+                    buf_cell (cur, y - 1, x + 1) + buf_cell (cur, y, x - 1) +
+                    buf_cell (cur, y, x + 1) + buf_cell (cur, y + 1, x - 1) +
+                    buf_cell (cur, y + 1, x) + buf_cell (cur, y + 1, x + 1);
+
+        buf_cell (next, y, x) = (n == 3) | (buf_cell (cur, y, x) & (n == 2));
+      }
+
+    // Seules les cellules de la tuile elle-même comptent : celles de la
+    // bordure fantôme sont prises en compte par les tuiles voisines
+    for (int y = k; y < k + tranche; y++)
+      if (memcmp (&buf_cell (next, y, k), &buf_cell (cur, y, k), tranche)) {
+        change |= 1U << (t - 1);
+        break;
+      }
+
+    uint8_t *tmp = cur;
+    cur          = next;
+    next         = tmp;
   }
 
-  f ();
+  // Recopie de l'intérieur de la tuile
+  for (int y = MAX (k, y_min); y <= MIN (k + tranche - 1, y_max); y++)
+    for (int x = MAX (k, x_min); x <= MIN (k + tranche - 1, x_max); x++)
+      next_cell (y0 + y, x0 + x) = buf_cell (cur, y, x);
+
+#undef buf_cell
+
+  return change;
 }
 
-static unsigned couleur = 0xFFFF00FF; // Yellow
+unsigned vie_compute_temporal (unsigned nb_iter)
+{
+  if (cur_cells == NULL)
+    cells_import ();
+
+  unsigned tranche = DIM / GRAIN;
+  size_t size      = (tranche + 2 * depth) * (tranche + 2 * depth);
+
+  for (unsigned it = 1; it <= nb_iter; it += depth) {
+    unsigned k      = MIN (depth, nb_iter - it + 1);
+    unsigned change = 0;
+
+#pragma omp parallel
+    {
+      uint8_t *cur  = malloc (size * sizeof (uint8_t));
+      uint8_t *next = malloc (size * sizeof (uint8_t));
+
+#pragma omp for collapse(2) schedule(runtime) reduction(| : change)
+      for (int i = 0; i < GRAIN; i++)
+        for (int j = 0; j < GRAIN; j++) {
+          change |= traiter_tuile_temporal (i * tranche, j * tranche, tranche,
+                                            k, cur, next);
+#ifdef ENABLE_MONITORING
+          monitoring_add_tile (j * tranche, i * tranche, tranche, tranche,
+                               omp_get_thread_num ());
+#endif
+        }
+
+      free (cur);
+      free (next);
+    }
+
+    swap_cells ();
+
+    // Première génération du bloc sans aucun changement
+    unsigned stable = ~change & (unsigned)((UINT64_C (1) << k) - 1);
+    if (stable)
+      return it + __builtin_ctz (stable);
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version tuilée paresseuse (lazy)
+
+// On mémorise pour chaque tuile si elle a changé lors de la génération
+// précédente. Une tuile n'est recalculée que si elle-même ou l'une de ses
+// huit voisines a changé : sinon, son contenu est déjà identique dans
+// cur_cells et next_cells et il n'y a rien à faire.
+
+static unsigned char *restrict tile_changed = NULL;
+static unsigned char *restrict next_changed = NULL;
+
+#define tile_state(i, j) (tile_changed[(i) * GRAIN + (j)])
+#define next_tile_state(i, j) (next_changed[(i) * GRAIN + (j)])
+
+void vie_init_lazy (void)
+{
+  tile_changed = malloc (GRAIN * GRAIN * sizeof (unsigned char));
+  next_changed = malloc (GRAIN * GRAIN * sizeof (unsigned char));
+
+  // Toutes les tuiles sont calculées à la première génération
+  memset (tile_changed, 1, GRAIN * GRAIN * sizeof (unsigned char));
+}
+
+void vie_finalize_lazy (void)
+{
+  free (tile_changed);
+  free (next_changed);
+  tile_changed = next_changed = NULL;
+
+  vie_finalize ();
+}
+
+static int tile_is_active (int i, int j)
+{
+  for (int k = MAX (i - 1, 0); k <= MIN (i + 1, GRAIN - 1); k++)
+    for (int l = MAX (j - 1, 0); l <= MIN (j + 1, GRAIN - 1); l++)
+      if (tile_state (k, l))
+        return 1;
+
+  return 0;
+}
+
+static inline void swap_tile_states (void)
+{
+  unsigned char *tmp = tile_changed;
+
+  tile_changed = next_changed;
+  next_changed = tmp;
+}
+
+unsigned vie_compute_lazy (unsigned nb_iter)
+{
+  if (cur_cells == NULL)
+    cells_import ();
+
+  unsigned tranche = DIM / GRAIN;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned change = 0;
+    uint64_t delta  = 0;
+
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++) {
+        unsigned c = 0;
+
+        if (tile_is_active (i, j)) {
+          c = traiter_tuile (i * tranche /* i debut */,
+                             j * tranche /* j debut */,
+                             (i + 1) * tranche - 1 /* i fin */,
+                             (j + 1) * tranche - 1 /* j fin */,
+                             cycle_delta (delta));
+#ifdef ENABLE_MONITORING
+          monitoring_add_tile (j * tranche, i * tranche, tranche, tranche, 0);
+#endif
+        }
+
+        next_tile_state (i, j) = c;
+        change |= c;
+      }
+
+    swap_cells ();
+    swap_tile_states ();
+
+    if (!change || cycle_detected (delta))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version utilisant un ordonnanceur maison (sched)
+
+// Chaque tuile est toujours confiée au même worker : les tuiles sont
+// réparties en bandes horizontales contiguës, si bien que les voisines d'une
+// tuile sont presque toujours traitées par le même cœur. C'est ce worker qui
+// touche en premier les lignes de ses tuiles (dans l'image avec -ft, dans
+// les grilles d'octets lors de l'import), les pages restent donc sur son banc
+// mémoire d'une génération à l'autre
+
+static unsigned nb_workers = 0, tranche = 0;
+static unsigned char *sched_change = NULL; // résultat de chaque tâche
+static uint64_t *sched_delta       = NULL;
+
+static inline void *pack_tile (int i, int j)
+{
+  uint64_t x = (uint64_t)i << 32 | j;
+  return (void *)x;
+}
+
+static inline void unpack_tile (void *a, int *i, int *j)
+{
+  *i = (uint64_t)a >> 32;
+  *j = (uint64_t)a & 0xFFFFFFFF;
+}
+
+static inline unsigned tile_owner (int i, int j)
+{
+  return i * nb_workers / GRAIN;
+}
+
+// Quand DIM n'est pas multiple de GRAIN, la dernière ligne (resp. colonne) de
+// tuiles se charge aussi des lignes (resp. colonnes) restantes lors du
+// premier contact et de l'import
+static inline int tile_end (int t)
+{
+  return (t == GRAIN - 1) ? DIM : (t + 1) * tranche;
+}
+
+static void create_tile_tasks (task_func_t t)
+{
+  for (int i = 0; i < GRAIN; i++)
+    for (int j = 0; j < GRAIN; j++)
+      scheduler_create_task (t, pack_tile (i, j), tile_owner (i, j));
+
+  scheduler_task_wait ();
+}
+
+void vie_init_sched (void)
+{
+  nb_workers   = scheduler_init (-1);
+  sched_change = malloc (GRAIN * GRAIN * sizeof (unsigned char));
+  sched_delta  = malloc (GRAIN * GRAIN * sizeof (uint64_t));
+}
+
+void vie_finalize_sched (void)
+{
+  scheduler_finalize ();
+
+  free (sched_change);
+  free (sched_delta);
+  sched_change = NULL;
+  sched_delta  = NULL;
+
+  vie_finalize ();
+}
+
+//////// First Touch
+
+static void first_touch_task (void *p, unsigned proc)
+{
+  int i, j;
+
+  unpack_tile (p, &i, &j);
+
+  for (int y = i * tranche; y < tile_end (i); y++)
+    for (int x = j * tranche; x < tile_end (j); x++)
+      cur_img (y, x) = next_img (y, x) = 0;
+}
+
+void vie_ft_sched (void)
+{
+  tranche = DIM / GRAIN;
+
+  create_tile_tasks (first_touch_task);
+}
+
+//////// Import
+
+static void import_task (void *p, unsigned proc)
+{
+  int i, j;
+
+  unpack_tile (p, &i, &j);
+
+  for (int y = i * tranche; y < tile_end (i); y++)
+    for (int x = j * tranche; x < tile_end (j); x++)
+      cur_cell (y, x) = next_cell (y, x) = (cur_img (y, x) != 0);
+}
+
+static void cells_import_sched (void)
+{
+  cur_cells  = malloc (DIM * DIM * sizeof (uint8_t));
+  next_cells = malloc (DIM * DIM * sizeof (uint8_t));
+
+  create_tile_tasks (import_task);
+
+  cycles_init ();
+}
+
+//////// Compute
+
+static void compute_task (void *p, unsigned proc)
+{
+  int i, j;
+
+  unpack_tile (p, &i, &j);
+
+  sched_delta[i * GRAIN + j]  = 0;
+  sched_change[i * GRAIN + j] = traiter_tuile (
+      i * tranche, j * tranche, (i + 1) * tranche - 1, (j + 1) * tranche - 1,
+      cycle_delta (sched_delta[i * GRAIN + j]));
+
+#ifdef ENABLE_MONITORING
+  monitoring_add_tile (j * tranche, i * tranche, tranche, tranche, proc);
+#endif
+}
+
+unsigned vie_compute_sched (unsigned nb_iter)
+{
+  tranche = DIM / GRAIN;
+
+  if (cur_cells == NULL)
+    cells_import_sched ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned change = 0;
+    uint64_t delta  = 0;
+
+    create_tile_tasks (compute_task);
+
+    // Les résultats des tâches sont combinés une fois toutes terminées
+    for (int t = 0; t < GRAIN * GRAIN; t++) {
+      change |= sched_change[t];
+      delta ^= sched_delta[t];
+    }
+
+    swap_cells ();
+
+    if (!change || cycle_detected (delta))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version thread point à point (thread_p2p)
+
+// Chaque thread possède une bande de lignes et publie, après chaque
+// génération, le numéro de la dernière génération calculée (écriture
+// « release »). Pour calculer la génération g, il attend seulement que ses
+// deux voisins aient terminé g - 1 (lecture « acquire ») : il lit alors leurs
+// lignes de bord à jour, et ils ont fini de lire les siennes dans le tampon
+// qu'il va écraser. Il n'y a pas de barrière globale et un thread peut avoir
+// une génération d'avance sur ses voisins (davantage sur des bandes
+// lointaines).
+//
+// Les deux grilles d'octets servent de tampons par parité de génération, ce
+// qui suffit pour les lignes de bord : aucun tampon supplémentaire n'est
+// nécessaire. La stabilisation est repérée sans synchronisation : chaque
+// bande note les générations où elle a changé, et une génération qu'aucune
+// bande (toutes l'ayant dépassée) n'a marquée est la génération de
+// stabilisation. Les threads en avance ne font alors que recopier l'état
+// stable. Un thread qui attend un voisin surveille aussi cette génération :
+// le voisin a pu s'arrêter avant de publier celle qu'il attend.
+//
+// Dans une version compilée avec P2P_TEST (make P2P_TEST=1), l'option
+// « p2p_stall=G » (ex. « --arg diehard,p2p_stall=131 ») retarde certains
+// threads autour de la génération G pour reproduire les entrelacements
+// délicats de la fin de calcul (voir script/test-p2p.sh).
+
+typedef struct
+{
+  atomic_uint gen;
+  char padding[64 - sizeof (atomic_uint)]; // pas de faux partage
+} band_t;
+
+static unsigned p2p_threads = 1, p2p_iterations = 0;
+static band_t *bands                 = NULL;
+static atomic_uchar *changed_at      = NULL;
+static atomic_uint stable_gen        = 0;
+static uint8_t *restrict p2p_grid[2] = {NULL, NULL};
+
+static int traiter_bande (const uint8_t *restrict src, uint8_t *restrict dst,
+                          int i_d, int i_f)
+{
+  const int w = DIM; // DIM est non signé
+  int change  = 0;
+
+  for (int y = MAX (i_d, 1); y <= MIN (i_f, w - 2); y++)
+    for (int x = 1; x < w - 1; x++) {
+      const uint8_t *c = src + y * w + x;
+      unsigned n = c[-w - 1] + c[-w] + c[-w + 1] + c[-1] + c[1] + c[w - 1] +
+                   c[w] + c[w + 1];
+      uint8_t alive = (n == 3) | (*c & (n == 2));
+
+      change |= (alive != *c);
+      dst[y * w + x] = alive;
+    }
+
+  return change;
+}
+
+// Renvoie 0 si la génération g + 1 n'a pas à être calculée, l'automate
+// s'étant stabilisé avant
+static int wait_band (unsigned b, unsigned g)
+{
+  while (atomic_load_explicit (&bands[b].gen, memory_order_acquire) < g) {
+    unsigned s = atomic_load_explicit (&stable_gen, memory_order_relaxed);
+
+    if (s != 0 && g >= s)
+      return 0;
+
+    sched_yield ();
+  }
+
+  return 1;
+}
+
+#ifdef P2P_TEST
+static unsigned p2p_stall = 0;
+
+// Le dernier thread s'endort avant de calculer la génération p2p_stall, les
+// threads intermédiaires après l'avoir publiée
+static void stall (unsigned me, unsigned g, int after)
+{
+  if (g != p2p_stall || me == 0)
+    return;
+
+  if (after ? me < p2p_threads - 1 : me == p2p_threads - 1)
+    usleep ((after ? 200 : 100) * 1000);
+}
+#endif
+
+// Recherche la première génération pendant laquelle aucune bande n'a changé
+// parmi celles que toutes les bandes ont terminées
+static void check_stable (unsigned *checked)
+{
+  unsigned m = p2p_iterations;
+
+  for (unsigned b = 0; b < p2p_threads; b++)
+    m = MIN (m, atomic_load_explicit (&bands[b].gen, memory_order_acquire));
+
+  for (unsigned g = *checked + 1; g <= m; g++)
+    if (!atomic_load_explicit (&changed_at[g], memory_order_relaxed)) {
+      unsigned expected = 0;
+      atomic_compare_exchange_strong (&stable_gen, &expected, g);
+      break;
+    }
+
+  *checked = m;
+}
+
+static void *thread_starter_p2p (void *arg)
+{
+  unsigned me      = (unsigned)(intptr_t)arg;
+  unsigned slice   = DIM / p2p_threads;
+  unsigned i_d     = me * slice;
+  unsigned i_f     = ((me == p2p_threads - 1) ? DIM - 1 : (me + 1) * slice - 1);
+  unsigned checked = 0;
+
+  PRINT_DEBUG ('t', "Thread %d/%d started, computing slice [%4u-%4u]\n", me,
+               p2p_threads, i_d, i_f);
+
+  for (unsigned g = 1; g <= p2p_iterations; g++) {
+    unsigned s = atomic_load_explicit (&stable_gen, memory_order_relaxed);
+
+    if (s != 0 && g > s)
+      break;
+
+    if (me > 0 && !wait_band (me - 1, g - 1))
+      break;
+    if (me < p2p_threads - 1 && !wait_band (me + 1, g - 1))
+      break;
+
+#ifdef P2P_TEST
+    stall (me, g, 0);
+#endif
+
+    if (traiter_bande (p2p_grid[(g - 1) & 1], p2p_grid[g & 1], i_d, i_f))
+      atomic_store_explicit (&changed_at[g], 1, memory_order_relaxed);
+
+#ifdef ENABLE_MONITORING
+    monitoring_add_tile (0, i_d, DIM, i_f - i_d + 1, me);
+#endif
+
+    atomic_store_explicit (&bands[me].gen, g, memory_order_release);
+
+    check_stable (&checked);
+
+#ifdef P2P_TEST
+    stall (me, g, 1);
+#endif
+  }
+
+  return NULL;
+}
+
+unsigned vie_compute_thread_p2p (unsigned nb_iter)
+{
+  char *str = getenv ("OMP_NUM_THREADS");
+
+  if (cur_cells == NULL)
+    cells_import ();
+
+  // Au moins une ligne par thread
+  int nb_threads = (str != NULL) ? atoi (str) : (int)get_nb_cores ();
+  p2p_threads    = MAX (1, MIN (nb_threads, (int)DIM));
+
+#ifdef P2P_TEST
+  p2p_stall = vie_option ("p2p_stall", 0);
+#endif
+
+  p2p_iterations = nb_iter;
+  p2p_grid[0]    = cur_cells;
+  p2p_grid[1]    = next_cells;
+  bands          = aligned_alloc (64, p2p_threads * sizeof (band_t));
+  changed_at     = calloc (nb_iter + 1, sizeof (atomic_uchar));
+  atomic_init (&stable_gen, 0);
+
+  for (unsigned b = 0; b < p2p_threads; b++)
+    atomic_init (&bands[b].gen, 0);
+
+  pthread_t pid[p2p_threads]; // pas de tableau de taille nulle
+
+  for (int i = 0; i < p2p_threads - 1; i++)
+    pthread_create (&pid[i], NULL, thread_starter_p2p,
+                    (void *)(intptr_t) (i + 1));
+
+  thread_starter_p2p (0);
+
+  for (int i = 0; i < p2p_threads - 1; i++)
+    pthread_join (pid[i], NULL);
+
+  unsigned stable = atomic_load (&stable_gen);
+
+  free (bands);
+  free (changed_at);
+
+  // Sans stabilisation, l'état courant est celui de la génération nb_iter ;
+  // sinon, les deux grilles contiennent l'état stable
+  if (stable == 0 && (nb_iter & 1))
+    swap_cells ();
+
+  return stable;
+}
+
+///////////////////////////// Version bit-packed (bitpacked)
+
+// L'univers est stocké sous forme de lignes de mots de 64 bits : le bit b du
+// mot w de la ligne y représente la cellule (y, 64 * w + b). Les voisins sont
+// additionnés « en tranches de bits » (additionneurs complets appliqués aux
+// 64 cellules d'un mot à la fois). L'image n'est reconstruite qu'au moment de
+// l'afficher ou de la sauvegarder (vie_refresh_img_bitpacked).
+
+static uint64_t *restrict cur_bits = NULL, *restrict next_bits = NULL;
+static uint64_t *restrict inner_mask = NULL; // cellules hors bordure, par mot
+static unsigned WORDS = 0;                   // nombre de mots par ligne
+
+#define cur_word(y, w) (cur_bits[(y) * WORDS + (w)])
+#define next_word(y, w) (next_bits[(y) * WORDS + (w)])
+
+static void bitpacked_import (void)
+{
+  WORDS = (DIM + 63) / 64;
+
+  cur_bits   = calloc (DIM * WORDS, sizeof (uint64_t));
+  next_bits  = calloc (DIM * WORDS, sizeof (uint64_t));
+  inner_mask = calloc (WORDS, sizeof (uint64_t));
+
+  for (int x = 1; x < DIM - 1; x++)
+    inner_mask[x / 64] |= (uint64_t)1 << (x % 64);
+
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      if (cur_img (y, x) != 0)
+        cur_word (y, x / 64) |= (uint64_t)1 << (x % 64);
+
+  // Les cellules de bordure ne changent jamais : on les recopie une fois pour
+  // toutes dans les deux tampons
+  memcpy (next_bits, cur_bits, DIM * WORDS * sizeof (uint64_t));
+}
+
+void vie_refresh_img_bitpacked (void)
+{
+  if (cur_bits == NULL)
+    return;
+
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      cur_img (y, x) = (cur_word (y, x / 64) >> (x % 64)) & 1 ? couleur : 0;
+}
+
+void vie_finalize_bitpacked (void)
+{
+  free (cur_bits);
+  free (next_bits);
+  free (inner_mask);
+  cur_bits = next_bits = inner_mask = NULL;
+}
+
+// Voisins de gauche (x - 1) des 64 cellules du mot w
+static inline uint64_t bits_left (const uint64_t *row, unsigned w)
+{
+  return (row[w] << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+}
+
+// Voisins de droite (x + 1) des 64 cellules du mot w
+static inline uint64_t bits_right (const uint64_t *row, unsigned w)
+{
+  return (row[w] >> 1) | (w < WORDS - 1 ? row[w + 1] << 63 : 0);
+}
+
+// Génération suivante des 64 cellules d'un mot, connaissant les mots de leurs
+// huit voisins (ul = voisins en haut à gauche, etc.)
+static inline uint64_t life_word (uint64_t ul, uint64_t uc, uint64_t ur,
+                                  uint64_t ml, uint64_t alive, uint64_t mr,
+                                  uint64_t dl, uint64_t dc, uint64_t dr)
+{
+  // Additionneurs complets sur les lignes du dessus et du dessous,
+  // demi-additionneur sur les deux voisins de la ligne courante
+  uint64_t s_up = ul ^ uc ^ ur, c_up = (ul & uc) | (ur & (ul ^ uc));
+  uint64_t s_dn = dl ^ dc ^ dr, c_dn = (dl & dc) | (dr & (dl ^ dc));
+  uint64_t s_mi = ml ^ mr, c_mi = ml & mr;
+
+  // Bit de poids 1 de la somme, et retenue de poids 2
+  uint64_t ones = s_up ^ s_dn ^ s_mi;
+  uint64_t c_on = (s_up & s_dn) | (s_mi & (s_up ^ s_dn));
+
+  // Nombre de retenues de poids 2 égal à exactement 1, i.e. somme des
+  // voisins égale à 2 ou 3
+  uint64_t p = c_up ^ c_dn, q = c_mi ^ c_on;
+  uint64_t two_or_three = (p ^ q) & ~((c_up & c_dn) | (c_mi & c_on));
+
+  return two_or_three & (ones | alive);
+}
+
+// Calcule la génération suivante des lignes [y_d-y_f] (hors bordure) et
+// renvoie un mot non nul si au moins une cellule a changé
+static uint64_t traiter_lignes_bitpacked (int y_d, int y_f)
+{
+  uint64_t change = 0;
+
+  for (int y = MAX (y_d, 1); y <= MIN (y_f, DIM - 2); y++) {
+    const uint64_t *up   = &cur_word (y - 1, 0);
+    const uint64_t *mid  = &cur_word (y, 0);
+    const uint64_t *down = &cur_word (y + 1, 0);
+
+    for (unsigned w = 0; w < WORDS; w++) {
+      uint64_t ul = bits_left (up, w), uc = up[w], ur = bits_right (up, w);
+      uint64_t dl = bits_left (down, w), dc = down[w],
+               dr = bits_right (down, w);
+      uint64_t ml = bits_left (mid, w), mr = bits_right (mid, w);
+
+      uint64_t alive = mid[w];
+      uint64_t n = life_word (ul, uc, ur, ml, alive, mr, dl, dc, dr);
+
+      n = (n & inner_mask[w]) | (alive & ~inner_mask[w]);
+
+      next_word (y, w) = n;
+      change |= n ^ alive;
+    }
+  }
+
+  return change;
+}
+
+static inline void swap_bits (void)
+{
+  uint64_t *tmp = cur_bits;
+
+  cur_bits  = next_bits;
+  next_bits = tmp;
+}
+
+unsigned vie_compute_bitpacked (unsigned nb_iter)
+{
+  if (cur_bits == NULL)
+    bitpacked_import ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    uint64_t change = traiter_lignes_bitpacked (0, DIM - 1);
+    swap_bits ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version par table de transition (lut, lut_omp)
+
+// Les 16 cellules d'un voisinage 4x4 forment un indice dans une table de 64K
+// entrées (64 Ko, qui tient dans le cache L2) donnant la génération suivante
+// du bloc 2x2 central : quatre cellules par accès, sans addition ni test. La
+// grille est celle de la version bitpacked : les quatre bits de chaque ligne
+// du voisinage s'extraient par simple décalage.
+
+static uint8_t life_lut[1 << 16];
+static uint64_t *lut_empty = NULL; // ligne vide, au-dessus et au-dessous
+
+// Bit (4 * l + c) de l'indice : cellule (l, c) du voisinage 4x4 ; bit
+// (2 * l + c) de l'entrée : cellule (l + 1, c + 1) à la génération suivante
+void vie_init_lut (void)
+{
+  for (unsigned idx = 0; idx < (1 << 16); idx++) {
+    uint8_t res = 0;
+
+    for (int y = 1; y <= 2; y++)
+      for (int x = 1; x <= 2; x++) {
+        unsigned n = 0;
+
+        for (int i = y - 1; i <= y + 1; i++)
+          for (int j = x - 1; j <= x + 1; j++)
+            if (i != y || j != x)
+              n += (idx >> (4 * i + j)) & 1;
+
+        unsigned alive = (idx >> (4 * y + x)) & 1;
+
+        if (n == 3 || (n == 2 && alive))
+          res |= 1 << (2 * (y - 1) + (x - 1));
+      }
+
+    life_lut[idx] = res;
+  }
+}
+
+void vie_refresh_img_lut (void)
+{
+  vie_refresh_img_bitpacked ();
+}
+
+void vie_finalize_lut (void)
+{
+  vie_finalize_bitpacked ();
+  free (lut_empty);
+  lut_empty = NULL;
+}
+
+static void lut_import (void)
+{
+  bitpacked_import ();
+  lut_empty = calloc (WORDS, sizeof (uint64_t));
+}
+
+// Ligne y de la grille, ou ligne vide hors de l'image
+static inline const uint64_t *lut_row (int y)
+{
+  return (y >= 0 && y < DIM) ? &cur_word (y, 0) : lut_empty;
+}
+
+// Calcule les blocs 2x2 des paires de lignes [p_d, p_f] (lignes 2p et 2p+1)
+// et des mots [w_d, w_f]
+static uint64_t traiter_tuile_lut (int p_d, int p_f, int w_d, int w_f)
+{
+  uint64_t change = 0;
+
+  for (int p = p_d; p <= p_f; p++) {
+    int y = 2 * p;
+    const uint64_t *rows[4] = {lut_row (y - 1), lut_row (y), lut_row (y + 1),
+                               lut_row (y + 2)};
+
+    for (int w = w_d; w <= w_f; w++) {
+      uint64_t ext[4], last[4];
+      uint64_t top = 0, bottom = 0;
+
+      // ext[l] contient les cellules 64w-1 à 64w+62 de la ligne l, last[l]
+      // les cellules 64w+61 à 64w+64 (dernier bloc du mot)
+      for (int l = 0; l < 4; l++) {
+        uint64_t prev = w > 0 ? rows[l][w - 1] : 0;
+        uint64_t next = w < WORDS - 1 ? rows[l][w + 1] : 0;
+
+        ext[l]  = rows[l][w] << 1 | prev >> 63;
+        last[l] = rows[l][w] >> 61 | (next & 1) << 3;
+      }
+
+      for (int k = 0; k < 64; k += 2) {
+        unsigned idx;
+
+        if (k < 62)
+          idx = ((ext[0] >> k) & 0xF) | ((ext[1] >> k) & 0xF) << 4 |
+                ((ext[2] >> k) & 0xF) << 8 | ((ext[3] >> k) & 0xF) << 12;
+        else
+          idx = last[0] | last[1] << 4 | last[2] << 8 | last[3] << 12;
+
+        uint64_t res = life_lut[idx];
+        top |= (res & 3) << k;
+        bottom |= (res >> 2) << k;
+      }
+
+      // Les cellules de bordure ne changent pas
+      if (y >= 1 && y <= DIM - 2) {
+        uint64_t alive = cur_word (y, w);
+        top = (top & inner_mask[w]) | (alive & ~inner_mask[w]);
+        next_word (y, w) = top;
+        change |= top ^ alive;
+      }
+      if (y + 1 <= DIM - 2) {
+        uint64_t alive = cur_word (y + 1, w);
+        bottom = (bottom & inner_mask[w]) | (alive & ~inner_mask[w]);
+        next_word (y + 1, w) = bottom;
+        change |= bottom ^ alive;
+      }
+    }
+  }
+
+  return change;
+}
+
+unsigned vie_compute_lut (unsigned nb_iter)
+{
+  if (cur_bits == NULL)
+    lut_import ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    // On traite toute l'image en un coup
+    uint64_t change = traiter_tuile_lut (0, (DIM - 1) / 2, 0, WORDS - 1);
+    swap_bits ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+void vie_init_lut_omp (void)
+{
+  vie_init_lut ();
+}
+
+void vie_refresh_img_lut_omp (void)
+{
+  vie_refresh_img_lut ();
+}
+
+void vie_finalize_lut_omp (void)
+{
+  vie_finalize_lut ();
+}
+
+unsigned vie_compute_lut_omp (unsigned nb_iter)
+{
+  if (cur_bits == NULL)
+    lut_import ();
+
+  // Tuiles de GRAIN x GRAIN, en paires de lignes et en mots
+  unsigned pairs = (DIM + 1) / 2;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    uint64_t change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int i = 0; i < GRAIN; i++)
+      for (int j = 0; j < GRAIN; j++) {
+        int p_d = i * pairs / GRAIN, p_f = (i + 1) * pairs / GRAIN - 1;
+        int w_d = j * WORDS / GRAIN, w_f = (j + 1) * WORDS / GRAIN - 1;
+
+        change |= traiter_tuile_lut (p_d, p_f, w_d, w_f);
+#ifdef ENABLE_MONITORING
+        monitoring_add_tile (w_d * 64, 2 * p_d,
+                             MIN ((w_f + 1) * 64, DIM) - w_d * 64,
+                             MIN (2 * (p_f + 1), DIM) - 2 * p_d,
+                             omp_get_thread_num ());
+#endif
+      }
+
+    swap_bits ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version HashLife (hashlife)
+
+// L'univers, non borné, est représenté par un quadtree dont les nœuds sont
+// uniques (hash-consing) : deux régions identiques partagent le même nœud.
+// Pour chaque nœud de niveau L (carré de 2^L cellules de côté), on mémorise
+// son centre (niveau L-1) avancé de 2^(L-2) générations, ou de 2^j
+// générations pour un saut plus court : nb_iter générations sont calculées
+// par sauts de 2^j. Seule la fenêtre [0, DIM[ x [0, DIM[ est recopiée dans
+// l'image, au moment de l'affichage. La taille du cache de nœuds (en Mo) se
+// règle avec « --arg cache=N » ; les nœuds inutiles sont récupérés entre
+// deux sauts dès que ce cache est plein.
+
+typedef struct
+{
+  uint32_t nw, ne, sw, se; // fils (HL_NONE pour une cellule)
+  uint32_t next;           // chaînage (table de hachage ou liste libre)
+  uint32_t result;         // centre avancé de 2^(level-2) générations
+  uint32_t partial;        // centre avancé de 2^partial_j générations
+  uint8_t level, partial_j, mark;
+  uint64_t pop; // nombre de cellules vivantes
+} hl_node_t;
+
+#define HL_NONE 0
+#define HL_DEAD 1
+#define HL_ALIVE 2
+#define HL_FREE 0xFF // niveau des nœuds de la liste libre
+#define HL_MIN_LEVEL 3
+#define HL_MAX_LEVEL 62
+#define HL_DEFAULT_CACHE 256 // Mo
+
+static hl_node_t *hl_nodes  = NULL;
+static uint32_t *hl_table   = NULL; // têtes des listes de la table de hachage
+static uint32_t hl_capacity = 0;    // taille de hl_nodes et de hl_table
+static uint32_t hl_used     = 0;    // premier indice jamais alloué
+static uint32_t hl_count    = 0;    // nombre de nœuds vivants
+static uint32_t hl_free     = HL_NONE;
+static uint32_t hl_max_nodes;
+static uint32_t hl_empty[HL_MAX_LEVEL + 1];
+
+static uint32_t hl_root   = HL_NONE;
+static int64_t hl_center = 0; // abscisse et ordonnée du centre de la racine
+
+#define hl_node(n) (hl_nodes[(n)])
+
+static inline uint32_t hl_hash (uint32_t nw, uint32_t ne, uint32_t sw,
+                                uint32_t se)
+{
+  uint64_t h = nw;
+
+  h = h * 0x9E3779B97F4A7C15ULL + ne;
+  h = h * 0x9E3779B97F4A7C15ULL + sw;
+  h = h * 0x9E3779B97F4A7C15ULL + se;
+
+  return (h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ULL >> 32;
+}
+
+static void hl_insert (uint32_t n)
+{
+  hl_node_t *p = &hl_node (n);
+  uint32_t h   = hl_hash (p->nw, p->ne, p->sw, p->se) & (hl_capacity - 1);
+
+  p->next     = hl_table[h];
+  hl_table[h] = n;
+}
+
+static void hl_rehash (void)
+{
+  for (uint32_t h = 0; h < hl_capacity; h++)
+    hl_table[h] = HL_NONE;
+
+  for (uint32_t n = HL_ALIVE + 1; n < hl_used; n++)
+    if (hl_node (n).level != HL_FREE)
+      hl_insert (n);
+}
+
+static uint32_t hl_alloc (void)
+{
+  uint32_t n;
+
+  if (hl_free != HL_NONE) {
+    n       = hl_free;
+    hl_free = hl_node (n).next;
+  } else {
+    if (hl_used == hl_capacity) {
+      if (hl_capacity == 1U << 31)
+        exit_with_error ("HashLife node cache exhausted\n");
+
+      hl_capacity *= 2;
+      hl_nodes = realloc (hl_nodes, hl_capacity * sizeof (hl_node_t));
+      hl_table = realloc (hl_table, hl_capacity * sizeof (uint32_t));
+      hl_rehash ();
+
+      PRINT_DEBUG ('c', "HashLife: node table grown to %u entries\n",
+                   hl_capacity);
+    }
+    n = hl_used++;
+  }
+
+  hl_count++;
+
+  return n;
+}
+
+static uint32_t hl_join (uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+  uint32_t h = hl_hash (nw, ne, sw, se) & (hl_capacity - 1);
+
+  for (uint32_t n = hl_table[h]; n != HL_NONE; n = hl_node (n).next)
+    if (hl_node (n).nw == nw && hl_node (n).ne == ne && hl_node (n).sw == sw &&
+        hl_node (n).se == se)
+      return n;
+
+  uint32_t n   = hl_alloc ();
+  hl_node_t *p = &hl_node (n);
+
+  p->nw = nw;
+  p->ne = ne;
+  p->sw = sw;
+  p->se = se;
+
+  p->level     = hl_node (nw).level + 1;
+  p->pop       = hl_node (nw).pop + hl_node (ne).pop + hl_node (sw).pop +
+           hl_node (se).pop;
+  p->result    = HL_NONE;
+  p->partial   = HL_NONE;
+  p->partial_j = 0;
+  p->mark      = 0;
+
+  hl_insert (n);
+
+  return n;
+}
+
+static uint32_t hl_empty_node (unsigned level)
+{
+  if (level == 0)
+    return HL_DEAD;
+
+  if (hl_empty[level] == HL_NONE) {
+    uint32_t e      = hl_empty_node (level - 1);
+    hl_empty[level] = hl_join (e, e, e, e);
+  }
+
+  return hl_empty[level];
+}
+
+// Nœud de niveau 2 (4x4 cellules) : calcul direct de la génération suivante
+// du carré central 2x2
+static uint32_t hl_base (uint32_t n)
+{
+  uint32_t quad[4] = {hl_node (n).nw, hl_node (n).ne, hl_node (n).sw,
+                      hl_node (n).se};
+  unsigned cell[4][4];
+  uint32_t next[4];
+
+  for (int q = 0; q < 4; q++) {
+    hl_node_t *p = &hl_node (quad[q]);
+    int y = (q / 2) * 2, x = (q % 2) * 2;
+
+    cell[y][x]         = (p->nw == HL_ALIVE);
+    cell[y][x + 1]     = (p->ne == HL_ALIVE);
+    cell[y + 1][x]     = (p->sw == HL_ALIVE);
+    cell[y + 1][x + 1] = (p->se == HL_ALIVE);
+  }
+
+  for (int y = 1; y <= 2; y++)
+    for (int x = 1; x <= 2; x++) {
+      unsigned n = 0;
+
+      for (int i = y - 1; i <= y + 1; i++)
+        for (int j = x - 1; j <= x + 1; j++)
+          if (i != y || j != x)
+            n += cell[i][j];
+
+      next[(y - 1) * 2 + (x - 1)] =
+          (n == 3 || (n == 2 && cell[y][x])) ? HL_ALIVE : HL_DEAD;
+    }
+
+  return hl_join (next[0], next[1], next[2], next[3]);
+}
+
+// Renvoie le centre du nœud n avancé de 2^min(j, level-2) générations
+static uint32_t hl_successor (uint32_t n, unsigned j)
+{
+  unsigned level = hl_node (n).level;
+
+  if (hl_node (n).pop == 0)
+    return hl_node (n).nw;
+
+  j = MIN (j, level - 2);
+
+  if (j == level - 2) {
+    if (hl_node (n).result != HL_NONE)
+      return hl_node (n).result;
+  } else if (hl_node (n).partial != HL_NONE && hl_node (n).partial_j == j)
+    return hl_node (n).partial;
+
+  uint32_t r;
+
+  if (level == 2)
+    r = hl_base (n);
+  else {
+    // Attention : hl_join peut déplacer hl_nodes, on copie donc les nœuds
+    hl_node_t nw = hl_node (hl_node (n).nw), ne = hl_node (hl_node (n).ne);
+    hl_node_t sw = hl_node (hl_node (n).sw), se = hl_node (hl_node (n).se);
+    uint32_t c[9];
+
+    // Les neuf sous-carrés de niveau level-1, avancés de 2^j générations
+    c[0] = hl_successor (hl_node (n).nw, j);
+    c[1] = hl_successor (hl_join (nw.ne, ne.nw, nw.se, ne.sw), j);
+    c[2] = hl_successor (hl_node (n).ne, j);
+    c[3] = hl_successor (hl_join (nw.sw, nw.se, sw.nw, sw.ne), j);
+    c[4] = hl_successor (hl_join (nw.se, ne.sw, sw.ne, se.nw), j);
+    c[5] = hl_successor (hl_join (ne.sw, ne.se, se.nw, se.ne), j);
+    c[6] = hl_successor (hl_node (n).sw, j);
+    c[7] = hl_successor (hl_join (sw.ne, se.nw, sw.se, se.sw), j);
+    c[8] = hl_successor (hl_node (n).se, j);
+
+    if (j < level - 2) {
+      // Saut court : on se contente de recoller les centres
+      hl_node_t q[9];
+
+      for (int i = 0; i < 9; i++)
+        q[i] = hl_node (c[i]);
+
+      uint32_t r_nw = hl_join (q[0].se, q[1].sw, q[3].ne, q[4].nw);
+      uint32_t r_ne = hl_join (q[1].se, q[2].sw, q[4].ne, q[5].nw);
+      uint32_t r_sw = hl_join (q[3].se, q[4].sw, q[6].ne, q[7].nw);
+      uint32_t r_se = hl_join (q[4].se, q[5].sw, q[7].ne, q[8].nw);
+
+      r = hl_join (r_nw, r_ne, r_sw, r_se);
+    } else {
+      // Saut complet : un second pas de 2^(level-3) générations
+      uint32_t r_nw = hl_successor (hl_join (c[0], c[1], c[3], c[4]), j);
+      uint32_t r_ne = hl_successor (hl_join (c[1], c[2], c[4], c[5]), j);
+      uint32_t r_sw = hl_successor (hl_join (c[3], c[4], c[6], c[7]), j);
+      uint32_t r_se = hl_successor (hl_join (c[4], c[5], c[7], c[8]), j);
+
+      r = hl_join (r_nw, r_ne, r_sw, r_se);
+    }
+  }
+
+  if (j == level - 2)
+    hl_node (n).result = r;
+  else {
+    hl_node (n).partial   = r;
+    hl_node (n).partial_j = j;
+  }
+
+  return r;
+}
+
+// Vrai si toutes les cellules vivantes sont dans le carré central
+static inline int hl_is_padded (uint32_t n)
+{
+  hl_node_t *p = &hl_node (n);
+
+  return hl_node (hl_node (p->nw).se).pop + hl_node (hl_node (p->ne).sw).pop +
+             hl_node (hl_node (p->sw).ne).pop +
+             hl_node (hl_node (p->se).nw).pop ==
+         p->pop;
+}
+
+// Double la taille du nœud, en le gardant centré
+static uint32_t hl_expand (uint32_t n)
+{
+  hl_node_t p = hl_node (n);
+  uint32_t e  = hl_empty_node (p.level - 1);
+
+  if (p.level == HL_MAX_LEVEL)
+    exit_with_error ("HashLife universe is too large\n");
+
+  uint32_t nw = hl_join (e, e, e, p.nw);
+  uint32_t ne = hl_join (e, e, p.ne, e);
+  uint32_t sw = hl_join (e, p.sw, e, e);
+  uint32_t se = hl_join (p.se, e, e, e);
+
+  return hl_join (nw, ne, sw, se);
+}
+
+// Réduit le nœud au plus petit carré centré contenant toutes les cellules
+static uint32_t hl_crop (uint32_t n)
+{
+  while (hl_node (n).level > HL_MIN_LEVEL && hl_is_padded (n)) {
+    hl_node_t p = hl_node (n);
+
+    n = hl_join (hl_node (p.nw).se, hl_node (p.ne).sw, hl_node (p.sw).ne,
+                 hl_node (p.se).nw);
+  }
+
+  return n;
+}
+
+// Avance l'univers n de 2^j générations
+static uint32_t hl_advance (uint32_t n, unsigned j)
+{
+  while (hl_node (n).level < j + 2 || !hl_is_padded (n))
+    n = hl_expand (n);
+
+  // Une marge supplémentaire garantit que les cellules, qui se déplacent
+  // d'au plus une case par génération, restent dans le résultat
+  n = hl_expand (n);
+
+  return hl_crop (hl_successor (n, j));
+}
+
+// Avance l'univers n d'un nombre quelconque de générations
+static uint32_t hl_advance_by (uint32_t n, unsigned nb_gen)
+{
+  for (unsigned j = 0; nb_gen != 0; j++, nb_gen >>= 1)
+    if (nb_gen & 1)
+      n = hl_advance (n, j);
+
+  return n;
+}
+
+static inline int hl_is_stable (uint32_t n)
+{
+  return hl_advance (n, 0) == n;
+}
+
+static void hl_mark (uint32_t n)
+{
+  if (n <= HL_ALIVE || hl_node (n).mark)
+    return;
+
+  hl_node (n).mark = 1;
+
+  hl_mark (hl_node (n).nw);
+  hl_mark (hl_node (n).ne);
+  hl_mark (hl_node (n).sw);
+  hl_mark (hl_node (n).se);
+  hl_mark (hl_node (n).result);
+  hl_mark (hl_node (n).partial);
+}
+
+static void hl_sweep (void)
+{
+  hl_mark (hl_root);
+  for (unsigned l = 1; l <= HL_MAX_LEVEL; l++)
+    hl_mark (hl_empty[l]);
+
+  for (uint32_t n = HL_ALIVE + 1; n < hl_used; n++) {
+    hl_node_t *p = &hl_node (n);
+
+    if (p->level == HL_FREE)
+      continue;
+
+    if (p->mark)
+      p->mark = 0;
+    else {
+      p->level = HL_FREE;
+      p->next  = hl_free;
+      hl_free  = n;
+      hl_count--;
+    }
+  }
+
+  hl_rehash ();
+}
+
+// Ramasse-miettes : on conserve les nœuds accessibles depuis la racine, ainsi
+// que les résultats mémorisés ; si cela ne suffit pas, on oublie ces derniers
+static void hl_collect (void)
+{
+  uint32_t before = hl_count;
+
+  hl_sweep ();
+
+  if (hl_count > hl_max_nodes / 2) {
+    for (uint32_t n = HL_ALIVE + 1; n < hl_used; n++)
+      hl_node (n).result = hl_node (n).partial = HL_NONE;
+
+    hl_sweep ();
+  }
+
+  PRINT_DEBUG ('c', "HashLife GC: %u -> %u nodes\n", before, hl_count);
+}
+
+static uint32_t hl_build (unsigned level, int64_t y, int64_t x)
+{
+  if (y >= DIM || x >= DIM)
+    return hl_empty_node (level);
+
+  if (level == 0)
+    return cur_img (y, x) != 0 ? HL_ALIVE : HL_DEAD;
+
+  int64_t half = INT64_C (1) << (level - 1);
+
+  uint32_t nw = hl_build (level - 1, y, x);
+  uint32_t ne = hl_build (level - 1, y, x + half);
+  uint32_t sw = hl_build (level - 1, y + half, x);
+  uint32_t se = hl_build (level - 1, y + half, x + half);
+
+  return hl_join (nw, ne, sw, se);
+}
+
+static void hl_import (void)
+{
+  unsigned level = HL_MIN_LEVEL;
+
+  while ((INT64_C (1) << level) < DIM)
+    level++;
+
+  hl_center = INT64_C (1) << (level - 1);
+  hl_root   = hl_crop (hl_build (level, 0, 0));
+}
+
+void vie_init_hashlife (void)
+{
+  unsigned cache = vie_option ("cache", HL_DEFAULT_CACHE);
+
+  hl_max_nodes = ((uint64_t)cache << 20) / sizeof (hl_node_t);
+  hl_capacity  = 1 << 16;
+  hl_used      = HL_ALIVE + 1;
+  hl_count     = 0;
+  hl_free      = HL_NONE;
+  hl_root      = HL_NONE;
+
+  hl_nodes = malloc (hl_capacity * sizeof (hl_node_t));
+  hl_table = malloc (hl_capacity * sizeof (uint32_t));
+  memset (hl_empty, 0, sizeof (hl_empty));
+
+  hl_nodes[HL_DEAD]  = (hl_node_t){.level = 0, .pop = 0};
+  hl_nodes[HL_ALIVE] = (hl_node_t){.level = 0, .pop = 1};
+
+  hl_rehash ();
+
+  PRINT_DEBUG ('c', "HashLife: cache of %u MB (%u nodes)\n", cache,
+               hl_max_nodes);
+}
+
+void vie_finalize_hashlife (void)
+{
+  free (hl_nodes);
+  free (hl_table);
+  hl_nodes = NULL;
+  hl_table = NULL;
+}
+
+static void hl_render (uint32_t n, int64_t y, int64_t x)
+{
+  int64_t size = INT64_C (1) << hl_node (n).level;
+
+  if (hl_node (n).pop == 0 || y >= DIM || x >= DIM || y + size <= 0 ||
+      x + size <= 0)
+    return;
+
+  if (hl_node (n).level == 0) {
+    cur_img (y, x) = couleur;
+    return;
+  }
+
+  hl_render (hl_node (n).nw, y, x);
+  hl_render (hl_node (n).ne, y, x + size / 2);
+  hl_render (hl_node (n).sw, y + size / 2, x);
+  hl_render (hl_node (n).se, y + size / 2, x + size / 2);
+}
+
+void vie_refresh_img_hashlife (void)
+{
+  if (hl_root == HL_NONE)
+    return;
+
+  int64_t origin = hl_center - (INT64_C (1) << (hl_node (hl_root).level - 1));
+
+  memset (&cur_img (0, 0), 0, DIM * DIM * sizeof (cur_img (0, 0)));
+  hl_render (hl_root, origin, origin);
+}
+
+unsigned vie_compute_hashlife (unsigned nb_iter)
+{
+  unsigned done = 0;
+
+  if (hl_root == HL_NONE)
+    hl_import ();
+
+  while (done < nb_iter) {
+    // Plus grand saut possible
+    unsigned j       = 31 - __builtin_clz (nb_iter - done);
+    uint32_t before  = hl_root;
+
+    if (hl_count > hl_max_nodes)
+      hl_collect ();
+
+    hl_root = hl_advance (hl_root, j);
+
+    // Racine inchangée : l'univers est stable, ou périodique de période
+    // divisant 2^j
+    if (hl_root == before) {
+      if (j == 0 || hl_is_stable (hl_root))
+        return done + 1;
+    } else if (j > 0 && hl_is_stable (hl_root)) {
+      // L'univers s'est stabilisé pendant le saut : on recherche par
+      // dichotomie la première génération stable
+      unsigned lo = 0, hi = 1U << j;
+
+      while (hi - lo > 1) {
+        unsigned mid = lo + (hi - lo) / 2;
+
+        if (hl_is_stable (hl_advance_by (before, mid)))
+          hi = mid;
+        else
+          lo = mid;
+      }
+
+      if (done + hi + 1 <= nb_iter)
+        return done + hi + 1;
+    }
+
+    done += 1U << j;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version creuse par blocs (sparse)
+
+// L'univers, non borné, n'est représenté que par ses blocs de 64x64 cellules
+// non vides, rangés dans une table de hachage à adressage ouvert indexée par
+// les coordonnées du bloc. Chaque ligne d'un bloc est un mot de 64 bits (voir
+// la version bitpacked). Un bloc voisin est créé dès que des cellules vivantes
+// atteignent le bord d'un bloc, et un bloc devenu vide est supprimé : mémoire
+// et temps de calcul sont proportionnels à la population. Seuls les blocs
+// visibles dans la fenêtre [0, DIM[ x [0, DIM[ sont recopiés dans l'image.
+
+#define CHUNK 64
+
+typedef struct
+{
+  int32_t cx, cy;  // coordonnées du bloc (en blocs)
+  unsigned index;  // position dans sp_chunks
+  uint64_t cur[CHUNK], next[CHUNK];
+} chunk_t;
+
+static chunk_t **sp_table  = NULL; // table de hachage (NULL : case libre)
+static unsigned sp_mask    = 0;    // taille de la table - 1
+static chunk_t **sp_chunks = NULL; // blocs existants
+static unsigned sp_count = 0, sp_max = 0;
+static int sp_loaded     = 0;
+
+static const chunk_t sp_void; // bloc vide, voisin des blocs en bordure
+
+static inline unsigned sp_hash (int32_t cx, int32_t cy)
+{
+  uint64_t h = ((uint64_t) (uint32_t)cx << 32 | (uint32_t)cy) *
+               0x9E3779B97F4A7C15ULL;
+
+  return (h >> 32) & sp_mask;
+}
+
+static chunk_t *sp_find (int32_t cx, int32_t cy)
+{
+  for (unsigned h = sp_hash (cx, cy); sp_table[h] != NULL;
+       h = (h + 1) & sp_mask)
+    if (sp_table[h]->cx == cx && sp_table[h]->cy == cy)
+      return sp_table[h];
+
+  return NULL;
+}
+
+static void sp_insert (chunk_t *c)
+{
+  unsigned h = sp_hash (c->cx, c->cy);
+
+  while (sp_table[h] != NULL)
+    h = (h + 1) & sp_mask;
+
+  sp_table[h] = c;
+}
+
+static chunk_t *sp_create (int32_t cx, int32_t cy)
+{
+  chunk_t *c = sp_find (cx, cy);
+
+  if (c != NULL)
+    return c;
+
+  // On garde un taux de remplissage inférieur à 1/2
+  if (2 * (sp_count + 1) > sp_mask + 1) {
+    unsigned size = 2 * (sp_mask + 1);
+
+    free (sp_table);
+    sp_table = calloc (size, sizeof (chunk_t *));
+    sp_mask  = size - 1;
+
+    for (unsigned i = 0; i < sp_count; i++)
+      sp_insert (sp_chunks[i]);
+  }
+
+  if (sp_count == sp_max) {
+    sp_max    = 2 * sp_max;
+    sp_chunks = realloc (sp_chunks, sp_max * sizeof (chunk_t *));
+  }
+
+  c        = calloc (1, sizeof (chunk_t));
+  c->cx    = cx;
+  c->cy    = cy;
+  c->index = sp_count;
+
+  sp_chunks[sp_count++] = c;
+  sp_insert (c);
+
+  return c;
+}
+
+static void sp_remove (chunk_t *c)
+{
+  unsigned h = sp_hash (c->cx, c->cy);
+
+  while (sp_table[h] != c)
+    h = (h + 1) & sp_mask;
+
+  // Suppression par décalage arrière : les éléments suivants de la même
+  // séquence de sondage reviennent combler le trou
+  for (unsigned next = (h + 1) & sp_mask; sp_table[next] != NULL;
+       next = (next + 1) & sp_mask) {
+    unsigned home = sp_hash (sp_table[next]->cx, sp_table[next]->cy);
+
+    if (((next - home) & sp_mask) >= ((next - h) & sp_mask)) {
+      sp_table[h] = sp_table[next];
+      h           = next;
+    }
+  }
+  sp_table[h] = NULL;
+
+  sp_chunks[c->index]        = sp_chunks[--sp_count];
+  sp_chunks[c->index]->index = c->index;
+
+  free (c);
+}
+
+static void sp_import (void)
+{
+  for (int y = 0; y < DIM; y++)
+    for (int x = 0; x < DIM; x++)
+      if (cur_img (y, x) != 0) {
+        chunk_t *c = sp_create (x / CHUNK, y / CHUNK);
+
+        c->cur[y % CHUNK] |= (uint64_t)1 << (x % CHUNK);
+      }
+
+  sp_loaded = 1;
+}
+
+void vie_init_sparse (void)
+{
+  sp_mask   = 1023;
+  sp_table  = calloc (sp_mask + 1, sizeof (chunk_t *));
+  sp_max    = 256;
+  sp_chunks = malloc (sp_max * sizeof (chunk_t *));
+  sp_count  = 0;
+  sp_loaded = 0;
+}
+
+void vie_finalize_sparse (void)
+{
+  for (unsigned i = 0; i < sp_count; i++)
+    free (sp_chunks[i]);
+
+  free (sp_chunks);
+  free (sp_table);
+  sp_chunks = NULL;
+  sp_table  = NULL;
+  sp_count  = 0;
+}
+
+void vie_refresh_img_sparse (void)
+{
+  if (!sp_loaded)
+    return;
+
+  memset (&cur_img (0, 0), 0, DIM * DIM * sizeof (cur_img (0, 0)));
+
+  for (unsigned i = 0; i < sp_count; i++) {
+    chunk_t *c = sp_chunks[i];
+    int64_t y0 = (int64_t)c->cy * CHUNK, x0 = (int64_t)c->cx * CHUNK;
+
+    if (y0 >= DIM || x0 >= DIM || y0 + CHUNK <= 0 || x0 + CHUNK <= 0)
+      continue;
+
+    for (int y = MAX (0, -y0); y < MIN (CHUNK, DIM - y0); y++)
+      for (int x = MAX (0, -x0); x < MIN (CHUNK, DIM - x0); x++)
+        if ((c->cur[y] >> x) & 1)
+          cur_img (y0 + y, x0 + x) = couleur;
+  }
+}
+
+// Crée les blocs voisins dans lesquels des naissances sont possibles
+static void sp_grow (void)
+{
+  unsigned count = sp_count; // les nouveaux blocs sont vides
+
+  for (unsigned i = 0; i < count; i++) {
+    chunk_t *c     = sp_chunks[i];
+    int32_t cx     = c->cx, cy = c->cy;
+    uint64_t first = c->cur[0], last = c->cur[CHUNK - 1];
+    uint64_t west = 0, east = 0;
+
+    for (int y = 0; y < CHUNK; y++) {
+      west |= c->cur[y] & 1;
+      east |= c->cur[y] >> (CHUNK - 1);
+    }
+
+    if (first)
+      sp_create (cx, cy - 1);
+    if (last)
+      sp_create (cx, cy + 1);
+    if (west)
+      sp_create (cx - 1, cy);
+    if (east)
+      sp_create (cx + 1, cy);
+    if (first & 1)
+      sp_create (cx - 1, cy - 1);
+    if (first >> (CHUNK - 1))
+      sp_create (cx + 1, cy - 1);
+    if (last & 1)
+      sp_create (cx - 1, cy + 1);
+    if (last >> (CHUNK - 1))
+      sp_create (cx + 1, cy + 1);
+  }
+}
+
+static inline const chunk_t *sp_neighbour (const chunk_t *c, int dx, int dy)
+{
+  const chunk_t *n = sp_find (c->cx + dx, c->cy + dy);
+
+  return n != NULL ? n : &sp_void;
+}
+
+static uint64_t sp_compute_chunk (chunk_t *c)
+{
+  const chunk_t *nw = sp_neighbour (c, -1, -1), *n = sp_neighbour (c, 0, -1);
+  const chunk_t *ne = sp_neighbour (c, 1, -1), *w = sp_neighbour (c, -1, 0);
+  const chunk_t *e = sp_neighbour (c, 1, 0), *sw = sp_neighbour (c, -1, 1);
+  const chunk_t *s = sp_neighbour (c, 0, 1), *se = sp_neighbour (c, 1, 1);
+  uint64_t change = 0;
+
+  for (int y = 0; y < CHUNK; y++) {
+    // Lignes y-1, y et y+1 du bloc et de ses voisins de gauche et de droite
+    uint64_t u  = y > 0 ? c->cur[y - 1] : n->cur[CHUNK - 1];
+    uint64_t uw = y > 0 ? w->cur[y - 1] : nw->cur[CHUNK - 1];
+    uint64_t ue = y > 0 ? e->cur[y - 1] : ne->cur[CHUNK - 1];
+    uint64_t d  = y < CHUNK - 1 ? c->cur[y + 1] : s->cur[0];
+    uint64_t dw = y < CHUNK - 1 ? w->cur[y + 1] : sw->cur[0];
+    uint64_t de = y < CHUNK - 1 ? e->cur[y + 1] : se->cur[0];
+    uint64_t m = c->cur[y], mw = w->cur[y], me = e->cur[y];
+
+    uint64_t next = life_word (
+        (u << 1) | (uw >> 63), u, (u >> 1) | (ue << 63), (m << 1) | (mw >> 63),
+        m, (m >> 1) | (me << 63), (d << 1) | (dw >> 63), d,
+        (d >> 1) | (de << 63));
+
+    c->next[y] = next;
+    change |= next ^ m;
+  }
+
+  return change;
+}
+
+unsigned vie_compute_sparse (unsigned nb_iter)
+{
+  if (!sp_loaded)
+    sp_import ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    uint64_t change = 0;
+
+    sp_grow ();
+
+#pragma omp parallel for schedule(dynamic, 16) reduction(| : change)
+    for (unsigned i = 0; i < sp_count; i++)
+      change |= sp_compute_chunk (sp_chunks[i]);
+
+    // Bascule des générations et suppression des blocs devenus vides
+    for (unsigned i = sp_count; i-- > 0;) {
+      chunk_t *c    = sp_chunks[i];
+      uint64_t live = 0;
+
+      memcpy (c->cur, c->next, sizeof (c->cur));
+      for (int y = 0; y < CHUNK; y++)
+        live |= c->cur[y];
+
+      if (!live)
+        sp_remove (c);
+    }
+
+    PRINT_DEBUG ('c', "Generation %u: %u chunks\n", it, sp_count);
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version vectorisée sur octets (vec)
+
+#if defined(ENABLE_VECTO) && (VEC_SIZE == 4 || VEC_SIZE == 8)
+
+// Sur la grille d'octets, un vecteur AVX2 (VEC_SIZE == 8) traite 32 cellules,
+// un vecteur SSE (VEC_SIZE == 4) 16
+#define VEC_CELLS (VEC_SIZE * 4)
+
+// Version scalaire sans branchement, utilisée pour les colonnes qui ne
+// remplissent pas un vecteur complet
+static inline uint8_t compute_new_cell (int y, int x)
+{
+  uint8_t n = cur_cell (y - 1, x - 1) + cur_cell (y - 1, x) +
+              cur_cell (y - 1, x + 1) + cur_cell (y, x - 1) +
+              cur_cell (y, x + 1) + cur_cell (y + 1, x - 1) +
+              cur_cell (y + 1, x) + cur_cell (y + 1, x + 1);
+  uint8_t alive = cur_cell (y, x);
+  uint8_t res   = (n == 3) | (alive & (n == 2));
+
+  next_cell (y, x) = res;
+
+  return res ^ alive;
+}
+
+#if VEC_SIZE == 8
+
+#define load_cells(y, x) _mm256_loadu_si256 ((__m256i *)&cur_cell ((y), (x)))
+
+static unsigned compute_multiple_cells (int y, int j_d, int j_f)
+{
+  __m256i un     = _mm256_set1_epi8 (1);
+  __m256i deux   = _mm256_set1_epi8 (2);
+  __m256i trois  = _mm256_set1_epi8 (3);
+  __m256i change = _mm256_setzero_si256 ();
+  int x;
+
+  for (x = j_d; x + VEC_CELLS - 1 <= j_f; x += VEC_CELLS) {
+    __m256i n = load_cells (y - 1, x - 1);
+    n = _mm256_add_epi8 (n, load_cells (y - 1, x));
+    n = _mm256_add_epi8 (n, load_cells (y - 1, x + 1));
+    n = _mm256_add_epi8 (n, load_cells (y, x - 1));
+    n = _mm256_add_epi8 (n, load_cells (y, x + 1));
+    n = _mm256_add_epi8 (n, load_cells (y + 1, x - 1));
+    n = _mm256_add_epi8 (n, load_cells (y + 1, x));
+    n = _mm256_add_epi8 (n, load_cells (y + 1, x + 1));
+
+    __m256i alive = load_cells (y, x);
+
+    // Cellule vivante : survit si n == 2 ou n == 3 ; cellule morte : naît si
+    // n == 3
+    __m256i eq3  = _mm256_cmpeq_epi8 (n, trois);
+    __m256i eq23 = _mm256_or_si256 (eq3, _mm256_cmpeq_epi8 (n, deux));
+    __m256i mask =
+        _mm256_blendv_epi8 (eq3, eq23, _mm256_cmpeq_epi8 (alive, un));
+    __m256i res  = _mm256_and_si256 (mask, un);
+
+    _mm256_storeu_si256 ((__m256i *)&next_cell (y, x), res);
+    change = _mm256_or_si256 (change, _mm256_xor_si256 (res, alive));
+  }
+
+  unsigned c = !_mm256_testz_si256 (change, change);
+
+  // Colonnes restantes
+  for (; x <= j_f; x++)
+    c |= compute_new_cell (y, x);
+
+  return c;
+}
+
+#elif VEC_SIZE == 4
+
+#define load_cells(y, x) _mm_loadu_si128 ((__m128i *)&cur_cell ((y), (x)))
+
+static unsigned compute_multiple_cells (int y, int j_d, int j_f)
+{
+  __m128i un     = _mm_set1_epi8 (1);
+  __m128i deux   = _mm_set1_epi8 (2);
+  __m128i trois  = _mm_set1_epi8 (3);
+  __m128i change = _mm_setzero_si128 ();
+  int x;
+
+  for (x = j_d; x + VEC_CELLS - 1 <= j_f; x += VEC_CELLS) {
+    __m128i n = load_cells (y - 1, x - 1);
+    n = _mm_add_epi8 (n, load_cells (y - 1, x));
+    n = _mm_add_epi8 (n, load_cells (y - 1, x + 1));
+    n = _mm_add_epi8 (n, load_cells (y, x - 1));
+    n = _mm_add_epi8 (n, load_cells (y, x + 1));
+    n = _mm_add_epi8 (n, load_cells (y + 1, x - 1));
+    n = _mm_add_epi8 (n, load_cells (y + 1, x));
+    n = _mm_add_epi8 (n, load_cells (y + 1, x + 1));
+
+    __m128i alive = load_cells (y, x);
+
+    __m128i eq3  = _mm_cmpeq_epi8 (n, trois);
+    __m128i eq23 = _mm_or_si128 (eq3, _mm_cmpeq_epi8 (n, deux));
+    __m128i mask = _mm_blendv_epi8 (eq3, eq23, _mm_cmpeq_epi8 (alive, un));
+    __m128i res  = _mm_and_si128 (mask, un);
+
+    _mm_storeu_si128 ((__m128i *)&next_cell (y, x), res);
+    change = _mm_or_si128 (change, _mm_xor_si128 (res, alive));
+  }
+
+  unsigned c = !_mm_testz_si128 (change, change);
+
+  for (; x <= j_f; x++)
+    c |= compute_new_cell (y, x);
+
+  return c;
+}
+
+#endif
+
+// Seules les cellules hors bordure sont calculées : la boucle vectorielle n'a
+// donc aucun test de bord
+static unsigned traiter_tuile_vec (int i_d, int j_d, int i_f, int j_f)
+{
+  unsigned change = 0;
+
+  PRINT_DEBUG ('c', "tuile [%d-%d][%d-%d] traitée\n", i_d, i_f, j_d, j_f);
+
+  j_d = MAX (j_d, 1);
+  j_f = MIN (j_f, DIM - 2);
+
+  for (int i = MAX (i_d, 1); i <= MIN (i_f, DIM - 2); i++)
+    change |= compute_multiple_cells (i, j_d, j_f);
+
+  return change;
+}
+
+unsigned vie_compute_vec (unsigned nb_iter)
+{
+  if (cur_cells == NULL)
+    cells_import ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    // On traite toute l'image en une seule fois
+    unsigned change = traiter_tuile_vec (0, 0, DIM - 1, DIM - 1);
+    swap_cells ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+#endif
+
+///////////////////////////// Configuration initiale
+
+void draw_stable (void);
+void draw_guns (void);
+void draw_random (void);
+void draw_clown (void);
+void draw_diehard (void);
+
+void vie_draw (char *param)
+{
+  char func_name[1024];
+  void (*f) (void) = NULL;
+  char *name       = NULL;
+
+  // On saute les options de la forme clé=valeur (voir vie_option)
+  for (char *p = param; p != NULL && name == NULL;) {
+    size_t len = strcspn (p, ",");
+
+    if (len > 0 && memchr (p, '=', len) == NULL)
+      name = p;
+    else
+      p = (p[len] == ',' ? p + len + 1 : NULL);
+  }
+
+  if (name == NULL)
+    f = draw_guns;
+  else {
+    sprintf (func_name, "draw_%.*s", (int)strcspn (name, ","), name);
+    f = dlsym (DLSYM_FLAG, func_name);
+
+    if (f == NULL) {
+      PRINT_DEBUG ('g', "Cannot resolve draw function: %s\n", func_name);
+      f = draw_guns;
+    }
+  }
+
+  f ();
+}
 
 static void gun (int x, int y, int version)
 {